@@ -0,0 +1,91 @@
+import argparse
+import sys
+
+# compare the Sedov radial profiles: the slicefile from the old serial
+# Diagnostics/Sedov tool, the slicefile from the current tool (built on
+# radial_profile::compute), and the profile written in-situ through
+# Castro::get_radial_profile at the end of the run.  The three bin the
+# same data in the same bins, so they should agree up to roundoff.
+
+RTOL = 1.e-10
+
+# the slicefiles set values smaller than this to 0
+SMALL = 1.e-20
+
+def read_columns(filename):
+    """return the rows of a file of whitespace-separated numbers,
+    skipping the comment lines"""
+
+    rows = []
+    with open(filename) as f:
+        for line in f:
+            if line.strip() == "" or line.lstrip().startswith("#"):
+                continue
+            rows.append([float(v) for v in line.split()])
+    return rows
+
+def read_slicefile(filename):
+    """return r and the density, velocity, pressure and internal energy
+    of each non-empty bin of a Diagnostics/Sedov slicefile"""
+
+    rows = [row for row in read_columns(filename) if row[1] != 0.0]
+    return [row[0] for row in rows], [row[1:5] for row in rows]
+
+def read_profile(filename):
+    """return r and the variables of each bin of a
+    radial_profile::write file (the weight column is dropped)"""
+
+    rows = read_columns(filename)
+    return [row[0] for row in rows], [row[2:] for row in rows]
+
+def compare(name, r_a, a, r_b, b, dr):
+    """compare the bins that are in both a and b"""
+
+    bins_a = {int(round(r / dr - 0.5)): n for n, r in enumerate(r_a)}
+    bins_b = {int(round(r / dr - 0.5)): n for n, r in enumerate(r_b)}
+
+    common = sorted(set(bins_a) & set(bins_b))
+    if len(common) < 0.9 * len(bins_a):
+        print(f"{name}: only {len(common)} of {len(bins_a)} bins in common")
+        return False
+
+    err = 0.0
+    for i in common:
+        for va, vb in zip(a[bins_a[i]], b[bins_b[i]]):
+            # the in-situ profile is not truncated at SMALL
+            if abs(vb) < SMALL:
+                vb = 0.0
+            err = max(err, abs(va - vb) / max(abs(va), SMALL))
+
+    print(f"{name}: {len(common)} bins, max relative difference {err:.3e}")
+
+    return err <= RTOL
+
+def doit(old_slice, new_slice, insitu):
+
+    r_old, old = read_slicefile(old_slice)
+    r_new, new = read_slicefile(new_slice)
+    r_insitu, prof = read_profile(insitu)
+
+    # the first bin is centered at dr/2
+    dr = 2.0 * read_columns(new_slice)[0][0]
+
+    ok = compare("old tool vs. new tool", r_old, old, r_new, new, dr)
+    ok = compare("new tool vs. in-situ", r_new, new, r_insitu, prof, dr) and ok
+
+    return ok
+
+if __name__ == "__main__":
+
+    p = argparse.ArgumentParser()
+    p.add_argument("old_slicefile", type=str,
+                   help="slicefile from the old Diagnostics/Sedov")
+    p.add_argument("new_slicefile", type=str,
+                   help="slicefile from the current Diagnostics/Sedov")
+    p.add_argument("profile", type=str,
+                   help="in-situ profile written by the Sedov problem")
+
+    args = p.parse_args()
+
+    if not doit(args.old_slicefile, args.new_slicefile, args.profile):
+        sys.exit(1)
@@ -2,27 +2,25 @@
 // Process a group of n-d plotfiles from the dustcollapse problem
 // and output the position of the interface as a function of time.
 //
-// For 2d:
-//              The initial dense sphere is assumed to be centered a r = 0 (x = 0).
-//		We take as default that it is centered vertically at y = 0, but
-//              this can be overridden with --yctr.
-//
-// For 3d:
-//		The initial dense sphere is assumed to be centered a x = y = z = 0,
-//              but this can be overridden with --{x,y,z}ctr.
+// The density is averaged in spherical shells about the center of the
+// problem (read from the plotfile's job_info) using the shared
+// radial_profile library, so this runs in parallel (MPI + OpenMP).
 //
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
 #include <regex>
-#include <AMReX_DataServices.H>
-#include <DustCollapse_F.H>
+#include <sstream>
+#include <AMReX_PlotFileUtil.H>
+
+#include <radial_profile.H>
 
 using namespace amrex;
+using std::string;
 
 std::string inputs_name = "";
 
-template <typename T>
-Vector<size_t> sort_indexes(const Vector<T> &v);
-
 string GetVarFromJobInfo (const string pltfile, const string varname);
 
 Vector<Real> GetCenter (const string pltfile);
@@ -63,190 +61,96 @@ int main(int argc, char* argv[])
 
 		string pltfile = argv[f];
 
-        auto center = GetCenter(pltfile);
-    	Real xctr = center[0];
-    	Real yctr = center[1];
-    	Real zctr = center[2];
-
-		// Start dataservices
-		DataServices::SetBatchMode();
-
-		// Define the type of file
-		Amrvis::FileType fileType(Amrvis::NEWPLT);
-		DataServices dataServices (pltfile, fileType);
-
-		if (!dataServices.AmrDataOk())
-			DataServices::Dispatch(DataServices::ExitRequest, NULL);
-
-		// get data from plot file
-		AmrData& data = dataServices.AmrDataRef();
-
-		int finestLevel = data.FinestLevel();
-
-		// get variable names
-		const Vector<string>& varNames = data.PlotVarNames();
-
-		// get the index bounds and dx.
-		Box domain = data.ProbDomain()[finestLevel];
-		auto dx = data.CellSize(finestLevel);
-		const Vector<Real>& problo = data.ProbLo();
-		const Vector<Real>& probhi = data.ProbHi();
-
-		Vector<int> rr = data.RefRatio();
-
-		auto rmin = problo[0];
-
-		const auto dx_fine = *(std::min_element(dx.begin(), dx.end()));
-
-		// compute the maximum number of zones, as if we were completely refined
-#if (AMREX_SPACEDIM == 1)
-		int nbins = domain.length(0);
-#elif (AMREX_SPACEDIM == 2)
-		auto x_maxdist = fmax(fabs(problo[0]), fabs(probhi[0]));
-		auto y_maxdist = fmax(fabs(problo[1] - yctr), fabs(probhi[1] - yctr));
-
-		auto max_dist = sqrt(x_maxdist*x_maxdist + y_maxdist*y_maxdist);
-
-		int nbins = int(max_dist / dx_fine);
-#else
-		auto x_maxdist = fmax(fabs(problo[0] - xctr), fabs(probhi[0] - xctr));
-		auto y_maxdist = fmax(fabs(problo[1] - yctr), fabs(probhi[1] - yctr));
-		auto z_maxdist = fmax(fabs(problo[2] - zctr), fabs(probhi[2] - zctr));
-
-		auto max_dist = sqrt(x_maxdist*x_maxdist + y_maxdist*y_maxdist +
-		                     z_maxdist*z_maxdist);
+		auto center = GetCenter(pltfile);
 
-		int nbins = int(max_dist / dx_fine);
-#endif
+		PlotFileData pf(pltfile);
 
-		// radial coordinate
-		Vector<Real> r(nbins);
-		for (auto i = 0; i < nbins; i++)
-			r[i] = (i + 0.5) * dx_fine + rmin;
+		int finestLevel = pf.finestLevel();
+		const int dim = pf.spaceDim();
 
 		// find variable indices
-		auto dens_comp = data.StateNumber("density");
+		const Vector<std::string>& varNames = pf.varNames();
 
-		if (dens_comp < 0 )
+		if (std::find(varNames.cbegin(), varNames.cend(), "density") == varNames.cend())
 			Abort("ERROR: density variable not found");
 
-		// allocate storage for data
-		Vector<Real> dens(nbins, 0.);
-		Vector<Real> volcount(nbins, 0);
-
-		// r1 is the factor between the current level grid spacing and the
-		// FINEST level
-		auto r1 = 1.0;
+		// volume-weighted spherical average of the density, in bins of
+		// the finest zone width out to the furthest corner of the domain
+		radial_profile::ProfileSpec spec;
+		for (int d = 0; d < AMREX_SPACEDIM && d < static_cast<int>(center.size()); d++)
+			spec.center[d] = center[d];
 
-		Vector<int> fill_comps(data.NComp());
-		for (auto i = 0; i < data.NComp(); i++)
-			fill_comps[i] = i;
+		Vector<MultiFab> dens_mf(finestLevel + 1);
+		Vector<const MultiFab*> dens_p(finestLevel + 1);
+		Vector<Geometry> geom(finestLevel + 1);
+		Vector<IntVect> ref_ratio(finestLevel);
 
-		// imask will be set to false if we've already output the data.
-		// Note, imask is defined in terms of the finest level.  As we loop
-		// over levels, we will compare to the finest level index space to
-		// determine if we've already output here
-		int mask_size = domain.length().max();
-		Vector<int> imask(pow(mask_size, AMREX_SPACEDIM), 1);
+		RealBox rb(pf.probLo(), pf.probHi());
 
-		// counter
-		int cnt = 0;
+		for (int l = 0; l <= finestLevel; l++) {
+			dens_mf[l] = pf.get(l, "density");
+			dens_p[l] = &dens_mf[l];
 
-		// loop over the data, starting at the finest grid, and if we haven't
-		// already stored data in that grid location (according to imask),
-		// store it.
-		for (int l = finestLevel; l >= 0; l--) {
+			geom[l].define(pf.probDomain(l), &rb, pf.coordSys());
 
-			Vector<Real> level_dx = data.DxLevel()[l];
+			if (l < finestLevel) {
+				IntVect ratio{pf.refRatio(l)};
+				for (int idim = dim; idim < AMREX_SPACEDIM; ++idim)
+					ratio[idim] = 1;
+				ref_ratio[l] = ratio;
+			}
+		}
 
-			const BoxArray& ba = data.boxArray(l);
-			const DistributionMapping& dm = data.DistributionMap(l);
+		radial_profile::set_default_bins(geom[finestLevel], spec);
 
-			MultiFab lev_data_mf(ba, dm, data.NComp(), data.NGrow());
-			data.FillVar(lev_data_mf, l, varNames, fill_comps);
+		auto prof = radial_profile::compute(dens_p, geom, ref_ratio, {0}, spec);
 
-#ifdef _OPENMP
-#pragma omp parallel
-#endif
-			for (MFIter mfi(lev_data_mf, true); mfi.isValid(); ++mfi) {
-				const Box& bx = mfi.tilebox();
-
-#if (AMREX_SPACEDIM == 1)
-				fdustcollapse1d(ARLIM_3D(bx.loVect()), ARLIM_3D(bx.hiVect()),
-				                BL_TO_FORTRAN_FAB(lev_data_mf[mfi]),
-				                nbins, dens.dataPtr(),
-				                imask.dataPtr(), mask_size, r1, dens_comp, &cnt);
-#elif (AMREX_SPACEDIM == 2)
-
-				fdustcollapse2d(ARLIM_3D(bx.loVect()), ARLIM_3D(bx.hiVect()),
-				                BL_TO_FORTRAN_FAB(lev_data_mf[mfi]),
-				                nbins, dens.dataPtr(), volcount.dataPtr(),
-				                imask.dataPtr(), mask_size, r1,
-				                ZFILL(level_dx), dx_fine, yctr, dens_comp);
-#else
-				fdustcollapse3d(bx.loVect(), bx.hiVect(),
-				                BL_TO_FORTRAN_FAB(lev_data_mf[mfi]),
-				                nbins, dens.dataPtr(), volcount.dataPtr(),
-				                imask.dataPtr(), mask_size, r1,
-				                level_dx.dataPtr(), dx_fine, xctr, yctr, zctr, dens_comp);
-#endif
+		// only keep the bins that hold data
+		Vector<Real> r;
+		Vector<Real> dens;
+		for (int i = 0; i < spec.nbins; i++) {
+			if (prof.weight[i] > 0.) {
+				r.push_back(prof.r[i]);
+				dens.push_back(prof.data[0][i]);
 			}
-
-			// adjust r1 for the next lowest level
-			if (l != 0) r1 *= rr[l-1];
 		}
+		const int nbins = r.size();
 
-#if (AMREX_SPACEDIM == 1)
-		// sort the data based on the coordinates
-		auto isv = sort_indexes(r);
-#else
-		// normalize
-		for (int i = 0; i < nbins; i++)
-			if (volcount[i] != 0.)
-				dens[i] /= volcount[i];
-#endif
+		const Real time = pf.time();
 
 		// These are calculated analytically given initial density 1.e9 and the
 		// analytic expression for the radius as a function of time t = 0.00
 		Real max_dens = 1.e9;
 
-		if (fabs(data.Time()) <= 1.e-8)
+		if (fabs(time) <= 1.e-8)
 			max_dens = 1.e9;
-		else if (fabs(data.Time() - 0.01) <= 1.e-8)
+		else if (fabs(time - 0.01) <= 1.e-8)
 			max_dens = 1.043345e9;
-		else if (fabs(data.Time() - 0.02) <= 1.e-8)
+		else if (fabs(time - 0.02) <= 1.e-8)
 			max_dens = 1.192524e9;
-		else if (fabs(data.Time() - 0.03) <= 1.e-8)
+		else if (fabs(time - 0.03) <= 1.e-8)
 			max_dens = 1.527201e9;
-		else if (fabs(data.Time() - 0.04) <= 1.e-8)
+		else if (fabs(time - 0.04) <= 1.e-8)
 			max_dens = 2.312884e9;
-		else if (fabs(data.Time() - 0.05) <= 1.e-8)
+		else if (fabs(time - 0.05) <= 1.e-8)
 			max_dens = 4.779133e9;
-		else if (fabs(data.Time() - 0.06) <= 1.e-8)
+		else if (fabs(time - 0.06) <= 1.e-8)
 			max_dens = 24.472425e9;
-		else if (fabs(data.Time() - 0.065) <= 1.e-8)
+		else if (fabs(time - 0.065) <= 1.e-8)
 			max_dens = 423.447291e9;
 		else {
-			Print() << "Dont know the maximum density at this time: " << data.Time() <<std::endl;
+			Print() << "Dont know the maximum density at this time: " << time <<std::endl;
 			Abort();
 		}
 
 		// loop over the solution, from r = 0 outward, and find the first
 		// place where the density drops below the threshold density
 		auto index = -1;
-#if (AMREX_SPACEDIM == 1)
-		for (auto i = 0; i < cnt; i++) {
-			if (dens[isv[i]] < 0.5 * max_dens) {
-				index = i;
-				break;
-			}
-#else
 		for (auto i = 0; i < nbins; i++) {
 			if (dens[i] < 0.5 * max_dens) {
 				index = i;
 				break;
 			}
-#endif
 		}
 
 		Real r_interface = 0.0;
@@ -265,11 +169,11 @@ int main(int argc, char* argv[])
 		}
 
 		// output
-		Print() << "\ntime = " << data.Time() << ", r_interface = "
+		Print() << "\ntime = " << time << ", r_interface = "
 		        << std::setprecision(16) << r_interface << std::endl << std::endl;
 
 		// dump out profile file
-		if (profile) {
+		if (profile && ParallelDescriptor::IOProcessor()) {
 			string outfile_name = pltfile;
 
 			if (pltfile.back() == '/')
@@ -300,22 +204,6 @@ int main(int argc, char* argv[])
 	amrex::Finalize();
 }
 
-template <typename T>
-Vector<size_t> sort_indexes(const Vector<T> &v) {
-
-	// initialize original index locations
-	Vector<size_t> idx(v.size());
-	iota(idx.begin(), idx.end(), 0);
-
-	// sort indexes based on comparing values in v
-	sort(idx.begin(), idx.end(),
-	     [&v](size_t i1, size_t i2) {
-		return v[i1] < v[i2];
-	});
-
-	return idx;
-}
-
 ///
 /// Gets the variable ``varname`` from the ``job_info`` file and returns as a
 /// string
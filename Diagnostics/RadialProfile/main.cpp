@@ -0,0 +1,312 @@
+//
+// Compute radial (spherical, cylindrical or plane-parallel) profiles
+// of any set of variables from a list of plotfiles, using the shared
+// radial_profile library.  The binning is parallel (MPI + OpenMP);
+// each plotfile writes <plotfile>.profile.
+//
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <regex>
+#include <string>
+#include <AMReX_PlotFileUtil.H>
+#include <AMReX_ParallelDescriptor.H>
+
+#include <radial_profile.H>
+
+using namespace amrex;
+
+std::string inputs_name = "";
+
+//
+// Prototypes
+//
+void GetInputArgs (const int argc, char** argv,
+                   Vector<std::string>& pltfiles, Vector<std::string>& vars,
+                   radial_profile::ProfileSpec& spec, bool& center_set);
+
+std::string GetVarFromJobInfo (const std::string pltfile, const std::string varname);
+
+Vector<Real> GetCenter (const std::string pltfile);
+
+Vector<std::string> SplitList (const std::string& list);
+
+void PrintHelp ();
+
+
+int main(int argc, char* argv[])
+{
+
+    amrex::Initialize(argc, argv, false);
+
+    // timer for profiling
+    BL_PROFILE_VAR("main()", pmain);
+
+    // Input arguments
+    Vector<std::string> pltfiles;
+    Vector<std::string> vars;
+    radial_profile::ProfileSpec spec_in;
+    bool center_set = false;
+
+    GetInputArgs (argc, argv, pltfiles, vars, spec_in, center_set);
+
+    for (const auto& pltfile : pltfiles) {
+
+        Real strt_time = ParallelDescriptor::second();
+
+        radial_profile::ProfileSpec spec = spec_in;
+
+        PlotFileData pf(pltfile);
+
+        const int fine_level = pf.finestLevel();
+        const int dim = pf.spaceDim();
+
+        // the center comes from the command line, then the job_info
+        // file, and is otherwise the center of the domain
+
+        if (!center_set) {
+            auto center = GetCenter(pltfile);
+            for (int d = 0; d < AMREX_SPACEDIM; ++d) {
+                spec.center[d] = (d < static_cast<int>(center.size())) ?
+                    center[d] : 0.5_rt * (pf.probLo()[d] + pf.probHi()[d]);
+            }
+        }
+
+        Vector<std::string> names = vars.empty() ? pf.varNames() : vars;
+        const int nvar = names.size();
+
+        if (spec.weight_type == radial_profile::mass) {
+            names.push_back("density");
+            spec.density_comp = nvar;
+        }
+
+        // read just the variables we need, level by level
+
+        Vector<MultiFab> data(fine_level + 1);
+        Vector<const MultiFab*> data_p(fine_level + 1);
+        Vector<Geometry> geom(fine_level + 1);
+        Vector<IntVect> ref_ratio(fine_level);
+
+        RealBox rb(pf.probLo(), pf.probHi());
+
+        for (int ilev = 0; ilev <= fine_level; ++ilev) {
+
+            data[ilev].define(pf.boxArray(ilev), pf.DistributionMap(ilev), names.size(), 0);
+
+            for (int n = 0; n < static_cast<int>(names.size()); ++n) {
+                const MultiFab& var = pf.get(ilev, names[n]);
+                MultiFab::Copy(data[ilev], var, 0, n, 1, 0);
+            }
+
+            data_p[ilev] = &data[ilev];
+
+            geom[ilev].define(pf.probDomain(ilev), &rb, pf.coordSys());
+
+            if (ilev < fine_level) {
+                IntVect ratio{pf.refRatio(ilev)};
+                for (int idim = dim; idim < AMREX_SPACEDIM; ++idim) {
+                    ratio[idim] = 1;
+                }
+                ref_ratio[ilev] = ratio;
+            }
+        }
+
+        radial_profile::set_default_bins(geom[fine_level], spec);
+
+        Vector<int> comps(nvar);
+        for (int n = 0; n < nvar; ++n) {
+            comps[n] = n;
+        }
+
+        auto profile = radial_profile::compute(data_p, geom, ref_ratio, comps, spec);
+
+        std::string outfile_name = pltfile;
+        if (outfile_name.back() == '/') {
+            outfile_name.pop_back();
+        }
+        outfile_name += ".profile";
+
+        names.resize(nvar);
+        radial_profile::write(outfile_name, profile, names);
+
+        Real end_time = ParallelDescriptor::second() - strt_time;
+        ParallelDescriptor::ReduceRealMax(end_time, ParallelDescriptor::IOProcessorNumber());
+
+        Print() << pltfile << " -> " << outfile_name << " (" << spec.nbins << " bins, "
+                << end_time << " s)" << std::endl;
+    }
+
+    // destroy timer for profiling
+    BL_PROFILE_VAR_STOP(pmain);
+
+    amrex::Finalize();
+}
+
+//
+// Parse command line arguments
+//
+void GetInputArgs ( const int argc, char** argv,
+                    Vector<std::string>& pltfiles, Vector<std::string>& vars,
+                    radial_profile::ProfileSpec& spec, bool& center_set)
+{
+
+    int i = 1; // skip program name
+
+    while ( i < argc)
+    {
+
+        if ( !strcmp(argv[i], "-v") || !strcmp(argv[i],"--vars") )
+        {
+            vars = SplitList(argv[++i]);
+        }
+        else if ( !strcmp(argv[i], "-t") || !strcmp(argv[i],"--type") )
+        {
+            std::string type = argv[++i];
+            if (type == "spherical") {
+                spec.radius_type = radial_profile::spherical;
+            } else if (type == "cylindrical") {
+                spec.radius_type = radial_profile::cylindrical;
+            } else if (type == "planar") {
+                spec.radius_type = radial_profile::planar;
+            } else {
+                Abort("unknown profile type " + type);
+            }
+        }
+        else if ( !strcmp(argv[i], "-w") || !strcmp(argv[i],"--weight") )
+        {
+            std::string weight = argv[++i];
+            if (weight == "volume") {
+                spec.weight_type = radial_profile::volume;
+            } else if (weight == "mass") {
+                spec.weight_type = radial_profile::mass;
+            } else {
+                Abort("unknown weighting " + weight);
+            }
+        }
+        else if ( !strcmp(argv[i], "-a") || !strcmp(argv[i],"--axis") )
+        {
+            spec.axis = std::stoi(argv[++i]);
+        }
+        else if ( !strcmp(argv[i], "-c") || !strcmp(argv[i],"--center") )
+        {
+            auto center = SplitList(argv[++i]);
+            for (int d = 0; d < static_cast<int>(center.size()) && d < 3; ++d) {
+                spec.center[d] = std::stod(center[d]);
+            }
+            center_set = true;
+        }
+        else if ( !strcmp(argv[i],"--rmin") )
+        {
+            spec.rmin = std::stod(argv[++i]);
+        }
+        else if ( !strcmp(argv[i],"--dr") )
+        {
+            spec.dr = std::stod(argv[++i]);
+        }
+        else if ( !strcmp(argv[i],"--nbins") )
+        {
+            spec.nbins = std::stoi(argv[++i]);
+        }
+        else if ( argv[i][0] == '-' )
+        {
+            Print() << "\n\nOption " << argv[i] << " not recognized" << std::endl;
+            PrintHelp ();
+            exit ( EXIT_FAILURE );
+        }
+        else
+        {
+            pltfiles.push_back(argv[i]);
+        }
+
+        // Go to the next parameter name
+        ++i;
+    }
+
+    if (pltfiles.empty())
+    {
+        PrintHelp();
+        Abort("Missing input file");
+    }
+
+    if (spec.axis < 0 || spec.axis >= AMREX_SPACEDIM)
+    {
+        Abort("axis must be between 0 and AMREX_SPACEDIM-1");
+    }
+}
+
+///
+/// Split a comma or space separated list
+///
+Vector<std::string> SplitList (const std::string& list)
+{
+    Vector<std::string> items;
+
+    std::string s = list;
+    std::replace(s.begin(), s.end(), ',', ' ');
+
+    std::istringstream iss {s};
+    std::string item;
+    while (iss >> item) {
+        items.push_back(item);
+    }
+
+    return items;
+}
+
+///
+/// Gets the variable ``varname`` from the ``job_info`` file and returns as a
+/// string
+///
+std::string GetVarFromJobInfo (const std::string pltfile, const std::string varname) {
+    std::string filename = pltfile + "/job_info";
+    std::regex re("(?:[ \\t]*)" + varname + "\\s*:\\s*(.*)\\s*\\n");
+
+    std::smatch m;
+
+    std::ifstream jobfile(filename);
+    if (jobfile.is_open()) {
+        std::stringstream buf;
+        buf << jobfile.rdbuf();
+        std::string file_contents = buf.str();
+
+        if (std::regex_search(file_contents, m, re)) {
+            return m[1];
+        }
+    }
+
+    return "";
+}
+
+// Get the center from the job info file and return as a Real Vector
+Vector<Real> GetCenter (const std::string pltfile) {
+    auto center_str = GetVarFromJobInfo(pltfile, "center");
+
+    // split string
+    std::istringstream iss {center_str};
+    Vector<Real> center;
+
+    std::string s;
+    while (std::getline(iss, s, ','))
+        center.push_back(stod(s));
+
+    return center;
+}
+
+//
+// Print usage info
+//
+void PrintHelp ()
+{
+    Print() << "\nusage: executable_name [args] plotfile [plotfile ...]"
+            << "\nargs [-v|--vars]     var1,var2,... : variables to profile (default: all)"
+            << "\n     [-t|--type]          type     : spherical (default), cylindrical or planar"
+            << "\n     [-w|--weight]        weight   : volume (default) or mass"
+            << "\n     [-a|--axis]          axis     : cylinder axis / plane normal (default: last dimension)"
+            << "\n     [-c|--center]        x,y,z    : center (default: from job_info, else the domain center)"
+            << "\n     [--rmin]             rmin     : inner edge of the first bin (default 0)"
+            << "\n     [--dr]               dr       : bin width (default: finest zone width)"
+            << "\n     [--nbins]            nbins    : number of bins (default: out to the furthest corner)"
+            << "\n\n" << std::endl;
+
+}
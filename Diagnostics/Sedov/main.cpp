@@ -10,6 +10,8 @@
 #include <AMReX_MultiFabUtil.H>
 #include <AMReX_ParallelDescriptor.H>
 
+#include <radial_profile.H>
+
 using namespace amrex;
 
 std::string inputs_name = "";
@@ -28,80 +30,6 @@ Vector<Real> GetCenter (const std::string pltfile);
 void PrintHelp ();
 
 
-std::pair<Real, Real> get_coord_info(const Array<Real, AMREX_SPACEDIM>& p,
-                                     const Vector<Real>& center,
-                                     const Array<Real, AMREX_SPACEDIM>& dx_level,
-                                     const int coord, const bool sphr) {
-
-
-    // compute radial coord and index
-
-    Real r_zone{0.0_rt};
-    Real vol = std::numeric_limits<Real>::quiet_NaN();
-
-#if AMREX_SPACEDIM == 1
-    // 1-d spherical geometry / spherical Sedov explosion
-
-    AMREX_ASSERT(coord == 2);
-
-    r_zone = p[0] - center[0];
-
-    Real r_r = p[0] + 0.5_rt * dx_level[0];
-    Real r_l = p[0] - 0.5_rt * dx_level[0];
-    vol = (4.0_rt/3.0_rt) * M_PI * dx_level[0] *
-        (r_r*r_r + r_l*r_r + r_l*r_l);
-
-#elif AMREX_SPACEDIM == 2
-    if (sphr) {
-        // 2-d axisymmetric geometry / spherical Sedov explosion
-
-        AMREX_ASSERT(coord == 1);
-
-        // axisymmetric V = pi (r_r**2 - r_l**2) * dz
-        //                = pi dr * dz * (r_r + r_l)
-        //                = 2 pi r dr dz
-
-        r_zone = std::sqrt((p[0] - center[0]) * (p[0] - center[0]) +
-                           (p[1] - center[1]) * (p[1] - center[1]));
-        vol = 2 * M_PI * p[0] * dx_level[0] * dx_level[1];
-
-    } else {
-        // 2-d Cartesian geometry / cylindrical Sedov explosion
-
-        AMREX_ASSERT(coord == 0);
-
-        r_zone = std::sqrt((p[0] - center[0]) * (p[0] - center[0]) +
-                           (p[1] - center[1]) * (p[1] - center[1]));
-        vol = dx_level[0] * dx_level[1];
-
-    }
-
-#else
-
-    AMREX_ASSERT(coord == 0);
-
-    vol = dx_level[0] * dx_level[1] * dx_level[2];
-
-    if (sphr) {
-        // 3-d Cartesian geometry / spherical Sedov explosion
-
-        r_zone = std::sqrt((p[0] - center[0]) * (p[0] - center[0]) +
-                           (p[1] - center[1]) * (p[1] - center[1]) +
-                           (p[2] - center[2]) * (p[2] - center[2]));
-
-    } else {
-        // 3-d Cartesian geometry / cylindrical Sedov explosion
-
-        r_zone = std::sqrt((p[0] - center[0]) * (p[0] - center[0]) +
-                           (p[1] - center[1]) * (p[1] - center[1]));
-
-    }
-#endif
-
-    return {r_zone, vol};
-
-}
-
 int main(int argc, char* argv[])
 {
 
@@ -191,167 +119,120 @@ int main(int argc, char* argv[])
 
     int coord = pf.coordSys();
 
-    // allocate storage for data
-    Vector<Real> dens_bin(nbins, 0.);
-    Vector<Real> vel_bin(nbins, 0.);
-    Vector<Real> pres_bin(nbins, 0.);
-    Vector<Real> e_bin(nbins, 0.);
-    Vector<Real> volcount(nbins, 0);
-
-    // we will use a mask that tells us if a zone on the current level
-    // is covered by data on a finer level.
-
-    for (int ilev = 0; ilev <= fine_level; ++ilev) {
-
-        Array<Real, AMREX_SPACEDIM> dx_level = pf.cellSize(ilev);
-
-        if (ilev < fine_level) {
-            IntVect ratio{pf.refRatio(ilev)};
-            for (int idim = dim; idim < AMREX_SPACEDIM; ++idim) {
-                ratio[idim] = 1;
-            }
-            const iMultiFab mask = makeFineMask(pf.boxArray(ilev), pf.DistributionMap(ilev),
-                                                pf.boxArray(ilev+1), ratio);
-
-            const MultiFab& lev_data_mf = pf.get(ilev);
-
-            for (MFIter mfi(lev_data_mf); mfi.isValid(); ++mfi) {
-                const Box& bx = mfi.validbox();
-                if (bx.ok()) {
-                    const auto& m = mask.array(mfi);
-                    const auto& fab = lev_data_mf.array(mfi);
-                    const auto lo = amrex::lbound(bx);
-                    const auto hi = amrex::ubound(bx);
-
-                    for (int k = lo.z; k <= hi.z; ++k) {
-                        for (int j = lo.y; j <= hi.y; ++j) {
-                            for (int i = lo.x; i <= hi.x; ++i) {
-                                if (m(i,j,k) == 0) { // not covered by fine
-
-                                    Array<Real,AMREX_SPACEDIM> p
-                                        = {AMREX_D_DECL(problo[0]+static_cast<Real>(i+0.5)*dx_level[0],
-                                                        problo[1]+static_cast<Real>(j+0.5)*dx_level[1],
-                                                        problo[2]+static_cast<Real>(k+0.5)*dx_level[2])};
-
-
-                                    const auto& [r_zone, vol] = get_coord_info(p, center, dx_level, coord, sphr);
-
-                                    int index = static_cast<int>(r_zone / dx_fine);
-
-                                    // add to the bin, weighting by the size
-
-                                    dens_bin[index] += fab(i,j,k,dens_comp) * vol;
-
-                                    vel_bin[index] +=
-                                        std::sqrt(std::pow(fab(i,j,k,xmom_comp), 2) +
-                                                  std::pow(fab(i,j,k,ymom_comp), 2) +
-                                                  std::pow(fab(i,j,k,zmom_comp), 2)) /
-                                        fab(i,j,k,dens_comp) * vol;
-
-                                    pres_bin[index] += fab(i,j,k,pres_comp) * vol;
-
-                                    e_bin[index] += (fab(i,j,k,rhoe_comp) / fab(i,j,k,dens_comp)) * vol;
-
-                                    volcount[index] += vol;
-
-                                } // mask
-
-                            }
-                        }
-                    }
+#if AMREX_SPACEDIM == 1
+    // 1-d spherical geometry / spherical Sedov explosion
+    AMREX_ASSERT(coord == 2);
+#elif AMREX_SPACEDIM == 2
+    // 2-d axisymmetric geometry for a spherical explosion, Cartesian
+    // for a cylindrical one (the radius is then measured in the plane)
+    AMREX_ASSERT(coord == (sphr ? 1 : 0));
+#else
+    AMREX_ASSERT(coord == 0);
+#endif
 
-                } // bx.ok()
+    // the quantities we bin: density, velocity, pressure and specific
+    // internal energy, on every level
 
-            } // MFIter
+    const int nvar = 4;
 
-        } else {
-            // this is the finest level
+    Vector<MultiFab> prim(fine_level + 1);
+    Vector<const MultiFab*> prim_p(fine_level + 1);
+    Vector<Geometry> geom(fine_level + 1);
+    Vector<IntVect> ref_ratio(fine_level);
 
-            const MultiFab& lev_data_mf = pf.get(ilev);
+    RealBox rb(problo, probhi);
 
-            for (MFIter mfi(lev_data_mf); mfi.isValid(); ++mfi) {
-                const Box& bx = mfi.validbox();
-                if (bx.ok()) {
-                    const auto& fab = lev_data_mf.array(mfi);
-                    const auto lo = amrex::lbound(bx);
-                    const auto hi = amrex::ubound(bx);
+    for (int ilev = 0; ilev <= fine_level; ++ilev) {
 
-                    for (int k = lo.z; k <= hi.z; ++k) {
-                        for (int j = lo.y; j <= hi.y; ++j) {
-                            for (int i = lo.x; i <= hi.x; ++i) {
+        const MultiFab& lev_data_mf = pf.get(ilev);
 
-                                Array<Real,AMREX_SPACEDIM> p
-                                    = {AMREX_D_DECL(problo[0]+static_cast<Real>(i+0.5)*dx_level[0],
-                                                    problo[1]+static_cast<Real>(j+0.5)*dx_level[1],
-                                                    problo[2]+static_cast<Real>(k+0.5)*dx_level[2])};
+        prim[ilev].define(lev_data_mf.boxArray(), lev_data_mf.DistributionMap(), nvar, 0);
 
-                                const auto& [r_zone, vol] = get_coord_info(p, center, dx_level, coord, sphr);
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        for (MFIter mfi(lev_data_mf, TilingIfNotGPU()); mfi.isValid(); ++mfi) {
+            const Box& bx = mfi.tilebox();
+            const auto& fab = lev_data_mf.const_array(mfi);
+            const auto& q = prim[ilev].array(mfi);
 
-                                int index = static_cast<int>(r_zone / dx_fine);
+            amrex::ParallelFor(bx,
+            [=] AMREX_GPU_HOST_DEVICE (int i, int j, int k) noexcept
+            {
+                q(i,j,k,0) = fab(i,j,k,dens_comp);
 
-                                // add to the bin, weighting by the size
+                q(i,j,k,1) = std::sqrt(fab(i,j,k,xmom_comp) * fab(i,j,k,xmom_comp) +
+                                       fab(i,j,k,ymom_comp) * fab(i,j,k,ymom_comp) +
+                                       fab(i,j,k,zmom_comp) * fab(i,j,k,zmom_comp)) /
+                    fab(i,j,k,dens_comp);
 
-                                dens_bin[index] += fab(i,j,k,dens_comp) * vol;
+                q(i,j,k,2) = fab(i,j,k,pres_comp);
 
-                                vel_bin[index] +=
-                                    std::sqrt(std::pow(fab(i,j,k,xmom_comp), 2) +
-                                              std::pow(fab(i,j,k,ymom_comp), 2) +
-                                              std::pow(fab(i,j,k,zmom_comp), 2)) /
-                                    fab(i,j,k,dens_comp) * vol;
+                q(i,j,k,3) = fab(i,j,k,rhoe_comp) / fab(i,j,k,dens_comp);
+            });
+        }
 
-                                pres_bin[index] += fab(i,j,k,pres_comp) * vol;
+        prim_p[ilev] = &prim[ilev];
 
-                                e_bin[index] += (fab(i,j,k,rhoe_comp) / fab(i,j,k,dens_comp)) * vol;
+        geom[ilev].define(pf.probDomain(ilev), &rb, coord);
 
-                                volcount[index] += vol;
-                                
-                            }
-                        }
-                    }
+        if (ilev < fine_level) {
+            IntVect ratio{pf.refRatio(ilev)};
+            for (int idim = dim; idim < AMREX_SPACEDIM; ++idim) {
+                ratio[idim] = 1;
+            }
+            ref_ratio[ilev] = ratio;
+        }
+    }
 
-                } // bx.ok()
+    // volume-weighted bins of width dx_fine
 
-            } // MFIter
+    radial_profile::ProfileSpec spec;
 
+    spec.center = {xctr, yctr, zctr};
+    spec.dr = dx_fine;
+    spec.nbins = nbins;
 
-        }
+#if AMREX_SPACEDIM == 3
+    if (!sphr) {
+        // 3-d Cartesian geometry / cylindrical Sedov explosion
+        spec.radius_type = radial_profile::cylindrical;
+        spec.axis = 2;
+    }
+#endif
 
-    } // level loop
+    auto profile = radial_profile::compute(prim_p, geom, ref_ratio, {0, 1, 2, 3}, spec);
 
+    Vector<Real>& dens_bin = profile.data[0];
+    Vector<Real>& vel_bin = profile.data[1];
+    Vector<Real>& pres_bin = profile.data[2];
+    Vector<Real>& e_bin = profile.data[3];
 
-    //normalize
-    for (int i = 0; i < nbins; i++) {
-        if (volcount[i] != 0.0) {
-            dens_bin[i] /= volcount[i];
-            vel_bin[i] /= volcount[i];
-            pres_bin[i] /= volcount[i];
-            e_bin[i] /= volcount[i];
+    // now open the slicefile and write out the data
+    if (ParallelDescriptor::IOProcessor()) {
+        std::ofstream slicefile;
+        slicefile.open(slcfile);
+        slicefile.setf(std::ios::scientific);
+        slicefile.precision(12);
+        const auto w = 24;
+
+        // write the header
+        slicefile << "# " << std::setw(w) << "x" << std::setw(w) << "density" << std::setw(w) << "velocity" << std::setw(w) << "pressure" << std::setw(w) << "int. energy" << std::endl;
+
+        // write the data in columns
+        const auto SMALL = 1.e-20;
+        for (auto i = 0; i < nbins; i++) {
+            if (fabs(dens_bin[i]) < SMALL) dens_bin[i] = 0.0;
+            if (fabs( vel_bin[i]) < SMALL) vel_bin[i] = 0.0;
+            if (fabs(pres_bin[i]) < SMALL) pres_bin[i] = 0.0;
+            if (fabs(   e_bin[i]) < SMALL) e_bin[i] = 0.0;
+
+            slicefile << std::setw(w) << r[i] << std::setw(w) << dens_bin[i] << std::setw(w) << vel_bin[i] << std::setw(w) << pres_bin[i] << std::setw(w) << e_bin[i] << std::endl;
         }
-    }
 
-    // now open the slicefile and write out the data
-    std::ofstream slicefile;
-    slicefile.open(slcfile);
-    slicefile.setf(std::ios::scientific);
-    slicefile.precision(12);
-    const auto w = 24;
-
-    // write the header
-    slicefile << "# " << std::setw(w) << "x" << std::setw(w) << "density" << std::setw(w) << "velocity" << std::setw(w) << "pressure" << std::setw(w) << "int. energy" << std::endl;
-
-    // write the data in columns
-    const auto SMALL = 1.e-20;
-    for (auto i = 0; i < nbins; i++) {
-        if (fabs(dens_bin[i]) < SMALL) dens_bin[i] = 0.0;
-        if (fabs( vel_bin[i]) < SMALL) vel_bin[i] = 0.0;
-        if (fabs(pres_bin[i]) < SMALL) pres_bin[i] = 0.0;
-        if (fabs(   e_bin[i]) < SMALL) e_bin[i] = 0.0;
-
-        slicefile << std::setw(w) << r[i] << std::setw(w) << dens_bin[i] << std::setw(w) << vel_bin[i] << std::setw(w) << pres_bin[i] << std::setw(w) << e_bin[i] << std::endl;
+        slicefile.close();
     }
 
-    slicefile.close();
-
     // destroy timer for profiling
     BL_PROFILE_VAR_STOP(pmain);
 
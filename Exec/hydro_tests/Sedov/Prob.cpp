@@ -0,0 +1,30 @@
+/* Implementations of functions in Problem.H go here */
+
+#include <Castro.H>
+#include <radial_profile.H>
+#include <prob_parameters.H>
+
+using namespace amrex;
+
+#ifdef DO_PROBLEM_POST_SIMULATION
+void Castro::problem_post_simulation(Vector<std::unique_ptr<AmrLevel> >& amr_level) {
+
+  // write the radial profile of the final state, computed in-situ.
+  // These are the same quantities (and bins) as the slicefile from
+  // Diagnostics/Sedov, so the two can be compared directly.
+
+  Castro& castro = dynamic_cast<Castro&>(*amr_level[0]);
+  Real time = castro.get_state_data(State_Type).curTime();
+
+  radial_profile::ProfileSpec spec;
+  for (int n = 0; n < 3; ++n) {
+      spec.center[n] = problem::center[n];
+  }
+
+  const Vector<std::string> names{"density", "magvel", "pressure", "eint_e"};
+
+  auto profile = castro.get_radial_profile(names, time, spec);
+
+  radial_profile::write("sedov_radial_profile.out", profile, names);
+}
+#endif
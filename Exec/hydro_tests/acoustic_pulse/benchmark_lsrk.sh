@@ -0,0 +1,55 @@
+#!/bin/bash
+
+# Compare the memory footprint and throughput of the low storage
+# Runge-Kutta method of lines integrator (time_integration_method = 4)
+# with CTU and with 2nd order SDC on the 3-d acoustic pulse.
+#
+# This needs two executables, since the method of lines integrators are
+# only built with USE_TRUE_SDC=TRUE:
+#
+#   make DIM=3 USE_MPI=TRUE -j 4
+#   make DIM=3 USE_MPI=TRUE USE_TRUE_SDC=TRUE -j 4
+#
+# For each integrator and problem size we report the runtime, the number
+# of steps, the zones advanced per second, the memory of the integrator
+# work arrays (from the state memory footprint Castro prints after
+# initialization), and the high water mark of the AMReX arena.
+
+DIM=3
+NPROCS=${NPROCS:-4}
+SIZES=${SIZES:-"64 128"}
+
+CTU_EXEC=./Castro${DIM}d.gnu.MPI.ex
+SDC_EXEC=./Castro${DIM}d.gnu.MPI.TRUESDC.ex
+
+COMMON="amr.plot_int=-1 amr.plot_per=-1 amr.check_int=-1 castro.fixed_dt=-1 castro.sum_interval=-1 castro.v=1 castro.print_memory_footprint=1 amrex.v=1 max_step=1000 stop_time=0.06"
+
+run () {
+    local name=$1
+    local exec=$2
+    local n=$3
+    shift 3
+
+    local out=bench_${name}_${n}.out
+
+    mpiexec -n ${NPROCS} ${exec} inputs.64 ${COMMON} amr.n_cell="${n} ${n} ${n}" "$@" &> ${out}
+
+    local runtime=$(grep "Run time without initialization" ${out} | awk '{print $NF}')
+    local nsteps=$(grep -c "^STEP = " ${out})
+    local work=$(grep "time integrator work arrays" ${out} | awk '{print $(NF-1)}')
+    local arena=$(grep -i "arena" ${out} | grep -i "max" | head -1)
+
+    local throughput=$(echo "${n}^3 * ${nsteps} / ${runtime}" | bc -l)
+
+    printf "%-8s %5d %8.3f %6d %12.4e %12.2f   %s\n" ${name} ${n} ${runtime} ${nsteps} ${throughput} ${work} "${arena}"
+}
+
+printf "%-8s %5s %8s %6s %12s %12s   %s\n" "method" "n" "time" "steps" "zones/s" "work (MB)" "arena"
+
+for n in ${SIZES}; do
+    run ctu  ${CTU_EXEC} ${n} castro.time_integration_method=0
+    run sdc2 ${SDC_EXEC} ${n} castro.time_integration_method=2 castro.sdc_order=2
+    for order in 2 3 4; do
+        run lsrk${order} ${SDC_EXEC} ${n} castro.time_integration_method=4 castro.sdc_order=2 castro.lsrk_order=${order}
+    done
+done
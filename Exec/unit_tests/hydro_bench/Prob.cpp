@@ -0,0 +1,516 @@
+/* Implementations of functions in Problem.H go here */
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+
+#include <Castro.H>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+using namespace amrex;
+
+void
+Castro::problem_post_init() {
+
+    if (level != 0) return;
+
+    hydro_kernel_bench();
+
+}
+
+
+void
+Castro::hydro_kernel_bench() {
+
+#if AMREX_SPACEDIM != 3 || defined(RADIATION) || defined(MHD) || defined(TRUE_SDC)
+    amrex::Abort("the hydro kernel benchmark requires a 3-d pure hydro CTU build");
+#else
+
+    // the benchmark settings
+
+    Vector<int> tile_sizes{8, 16, 32, 1024};
+    Vector<int> thread_counts;
+    int nreps = 3;
+    std::string output_file = "hydro_bench.csv";
+
+    {
+        ParmParse pp("bench");
+        pp.queryarr("tile_sizes", tile_sizes);
+        pp.queryarr("nthreads", thread_counts);
+        pp.query("nreps", nreps);
+        pp.query("output_file", output_file);
+    }
+
+    if (thread_counts.empty()) {
+#ifdef _OPENMP
+        thread_counts.push_back(omp_get_max_threads());
+#else
+        thread_counts.push_back(1);
+#endif
+    }
+
+    // the stages we time.  The CTU ones are done in the order of
+    // construct_ctu_hydro_source, so each stage sees the output of the
+    // previous ones
+
+    enum BenchStage : int {
+        ctoprim_stage = 0, uflatten_stage, shock_stage,
+        trace_plm_stage, trace_ppm_stage,
+        cmpflx_stage, trans_single_stage, trans_final_stage,
+        consup_hydro_stage,
+        mol_ppm_reconstruct_stage, mol_consup_stage,
+        num_stages
+    };
+
+    const Vector<std::string> stage_names{"ctoprim", "uflatten", "shock",
+                                          "trace_plm", "trace_ppm",
+                                          "cmpflx_plus_godunov", "trans_single", "trans_final",
+                                          "consup_hydro",
+                                          "mol_ppm_reconstruct", "mol_consup"};
+
+    // the synthetic state is the initial data, with NUM_GROW ghost
+    // cells filled from the periodic images
+
+    const MultiFab& S_new = get_new_data(State_Type);
+
+    MultiFab U(grids, dmap, NUM_STATE, NUM_GROW);
+    MultiFab::Copy(U, S_new, 0, 0, NUM_STATE, 0);
+    U.FillBoundary(geom.periodicity());
+
+    MultiFab U_update(grids, dmap, NUM_STATE, 0);
+
+    const Real time = state[State_Type].curTime();
+    const Real dt = estTimeStep();
+
+    const Real* dx = geom.CellSize();
+
+    const Real hdt = 0.5*dt;
+    const Real hdtdx = 0.5*dt/dx[0];
+    const Real hdtdy = 0.5*dt/dx[1];
+    const Real hdtdz = 0.5*dt/dx[2];
+    const Real cdtdx = dt/dx[0]/3.0;
+    const Real cdtdy = dt/dx[1]/3.0;
+    const Real cdtdz = dt/dx[2]/3.0;
+
+    const Real nzones = static_cast<Real>(grids.numPts());
+
+#ifdef _OPENMP
+    const int max_threads = amrex::max(omp_get_max_threads(),
+                                       *std::max_element(thread_counts.begin(), thread_counts.end()));
+#else
+    const int max_threads = 1;
+#endif
+
+    std::ofstream ofile;
+    if (ParallelDescriptor::IOProcessor()) {
+        ofile.open(output_file);
+        ofile << "stage,tile_size,nthreads,ncomp,nzones,nreps,thread_seconds,share,ns_per_zone" << std::endl;
+    }
+
+    amrex::Print() << std::endl << "hydro kernel benchmark: " << grids.numPts() << " zones, "
+                   << NUM_STATE << " conserved variables, "
+                   << nreps << " repetitions" << std::endl;
+
+    for (int tile_size : tile_sizes) {
+
+        for (int nthreads : thread_counts) {
+
+#ifdef _OPENMP
+            omp_set_num_threads(nthreads);
+#endif
+
+            // per-thread accumulated time in each stage, and in the
+            // whole tile loop (the last entry of each thread)
+            Vector<Real> stage_time(max_threads * (num_stages + 1), 0.0_rt);
+
+            // the wall clock time of the whole pipeline
+            Real wall_time = 0.0_rt;
+
+            for (int rep = 0; rep < nreps; ++rep) {
+
+            ParallelDescriptor::Barrier();
+            const Real wall_start = amrex::second();
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+            {
+
+#ifdef _OPENMP
+                Real* my_time = &stage_time[omp_get_thread_num() * (num_stages + 1)];
+#else
+                Real* my_time = &stage_time[0];
+#endif
+
+                const Real loop_start = amrex::second();
+
+                auto timed = [=] (const int stage, auto&& f)
+                {
+                    const Real t0 = amrex::second();
+                    f();
+                    Gpu::streamSynchronize();
+                    my_time[stage] += amrex::second() - t0;
+                };
+
+                FArrayBox q, qaux, rho_inv, src_q, flatn, shk;
+                FArrayBox qxm, qxp, qym, qyp, qzm, qzp;
+                FArrayBox ftmp[3], qgtmp[3];
+                FArrayBox qmyx, qpyx, qmzx, qpzx, qmxy, qpxy;
+                FArrayBox qmzy, qpzy, qmxz, qpxz, qmyz, qpyz;
+                FArrayBox fc1, fc2, qgc1, qgc2;
+                FArrayBox ql, qr;
+                FArrayBox flux[3], qe[3];
+                FArrayBox q_full, srcU;
+
+                for (MFIter mfi(U, IntVect(tile_size)); mfi.isValid(); ++mfi) {
+
+                    const Box& bx = mfi.tilebox();
+                    const Box& obx = amrex::grow(bx, 1);
+                    const Box& qbx = amrex::grow(bx, NUM_GROW);
+                    const Box& qbx3 = amrex::grow(bx, 3);
+
+                    const Box& xbx = amrex::surroundingNodes(bx, 0);
+                    const Box& ybx = amrex::surroundingNodes(bx, 1);
+                    const Box& zbx = amrex::surroundingNodes(bx, 2);
+
+                    Array4<Real const> const U_arr = U.array(mfi);
+
+                    q.resize(qbx, NQTHERM);
+                    qaux.resize(qbx, NQAUX);
+                    rho_inv.resize(qbx3, 1);
+                    src_q.resize(qbx3, NQSRC);
+                    flatn.resize(obx, 1);
+                    shk.resize(obx, 1);
+
+                    auto q_arr = q.array();
+                    auto qaux_arr = qaux.array();
+                    auto rho_inv_arr = rho_inv.array();
+                    auto src_q_arr = src_q.array();
+                    auto flatn_arr = flatn.array();
+                    auto shk_arr = shk.array();
+
+                    src_q.setVal<RunOn::Device>(0.0);
+
+                    amrex::ParallelFor(qbx3,
+                    [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+                    {
+                        rho_inv_arr(i,j,k) = 1.0 / U_arr(i,j,k,URHO);
+                    });
+
+                    timed(ctoprim_stage, [&] () {
+                        ctoprim(qbx, time, U_arr, q_arr, qaux_arr);
+                    });
+
+                    timed(uflatten_stage, [&] () {
+                        uflatten(obx, q_arr, flatn_arr, QPRES);
+                    });
+
+                    timed(shock_stage, [&] () {
+                        shock(obx, q_arr, shk_arr);
+                    });
+
+                    // the normal interface states
+
+                    qxm.resize(obx, NQ);
+                    qxp.resize(obx, NQ);
+                    qym.resize(obx, NQ);
+                    qyp.resize(obx, NQ);
+                    qzm.resize(obx, NQ);
+                    qzp.resize(obx, NQ);
+
+                    auto qxm_arr = qxm.array();
+                    auto qxp_arr = qxp.array();
+                    auto qym_arr = qym.array();
+                    auto qyp_arr = qyp.array();
+                    auto qzm_arr = qzm.array();
+                    auto qzp_arr = qzp.array();
+
+                    timed(trace_plm_stage, [&] () {
+                        ctu_plm_states(obx, bx,
+                                       U_arr, rho_inv_arr,
+                                       q_arr, qaux_arr, src_q_arr,
+                                       qxm_arr, qxp_arr,
+                                       qym_arr, qyp_arr,
+                                       qzm_arr, qzp_arr,
+                                       false, dt);
+                    });
+
+                    timed(trace_ppm_stage, [&] () {
+                        ctu_ppm_states(obx, bx,
+                                       U_arr, rho_inv_arr,
+                                       q_arr, qaux_arr, src_q_arr,
+                                       qxm_arr, qxp_arr,
+                                       qym_arr, qyp_arr,
+                                       qzm_arr, qzp_arr,
+                                       false, dt);
+                    });
+
+                    // the fluxes from the normal states
+
+                    for (int idir = 0; idir < 3; ++idir) {
+                        ftmp[idir].resize(obx, NUM_STATE);
+                        qgtmp[idir].resize(obx, NGDNV);
+                    }
+
+                    Array4<Real> const ftmp_arr[3] = {ftmp[0].array(), ftmp[1].array(), ftmp[2].array()};
+                    Array4<Real> const qgtmp_arr[3] = {qgtmp[0].array(), qgtmp[1].array(), qgtmp[2].array()};
+
+                    const Box& cxbx = amrex::grow(xbx, IntVect(0,1,1));
+                    const Box& cybx = amrex::grow(ybx, IntVect(1,0,1));
+                    const Box& czbx = amrex::grow(zbx, IntVect(1,1,0));
+
+                    timed(cmpflx_stage, [&] () {
+                        cmpflx_plus_godunov(cxbx, qxm_arr, qxp_arr, ftmp_arr[0], qgtmp_arr[0],
+                                            qaux_arr, shk_arr, 0, false);
+                        cmpflx_plus_godunov(cybx, qym_arr, qyp_arr, ftmp_arr[1], qgtmp_arr[1],
+                                            qaux_arr, shk_arr, 1, false);
+                        cmpflx_plus_godunov(czbx, qzm_arr, qzp_arr, ftmp_arr[2], qgtmp_arr[2],
+                                            qaux_arr, shk_arr, 2, false);
+                    });
+
+                    // the transverse corrections to the normal states
+
+                    const Box& tyxbx = amrex::grow(ybx, IntVect(0,0,1));
+                    const Box& tzxbx = amrex::grow(zbx, IntVect(0,1,0));
+                    const Box& txybx = amrex::grow(xbx, IntVect(0,0,1));
+                    const Box& tzybx = amrex::grow(zbx, IntVect(1,0,0));
+                    const Box& txzbx = amrex::grow(xbx, IntVect(0,1,0));
+                    const Box& tyzbx = amrex::grow(ybx, IntVect(1,0,0));
+
+                    qmyx.resize(tyxbx, NQ);
+                    qpyx.resize(tyxbx, NQ);
+                    qmzx.resize(tzxbx, NQ);
+                    qpzx.resize(tzxbx, NQ);
+                    qmxy.resize(txybx, NQ);
+                    qpxy.resize(txybx, NQ);
+                    qmzy.resize(tzybx, NQ);
+                    qpzy.resize(tzybx, NQ);
+                    qmxz.resize(txzbx, NQ);
+                    qpxz.resize(txzbx, NQ);
+                    qmyz.resize(tyzbx, NQ);
+                    qpyz.resize(tyzbx, NQ);
+
+                    timed(trans_single_stage, [&] () {
+                        trans_single(tyxbx, 0, 1, qym_arr, qmyx.array(), qyp_arr, qpyx.array(),
+                                     qaux_arr, ftmp_arr[0], qgtmp_arr[0], hdt, cdtdx);
+                        trans_single(tzxbx, 0, 2, qzm_arr, qmzx.array(), qzp_arr, qpzx.array(),
+                                     qaux_arr, ftmp_arr[0], qgtmp_arr[0], hdt, cdtdx);
+                        trans_single(txybx, 1, 0, qxm_arr, qmxy.array(), qxp_arr, qpxy.array(),
+                                     qaux_arr, ftmp_arr[1], qgtmp_arr[1], hdt, cdtdy);
+                        trans_single(tzybx, 1, 2, qzm_arr, qmzy.array(), qzp_arr, qpzy.array(),
+                                     qaux_arr, ftmp_arr[1], qgtmp_arr[1], hdt, cdtdy);
+                        trans_single(txzbx, 2, 0, qxm_arr, qmxz.array(), qxp_arr, qpxz.array(),
+                                     qaux_arr, ftmp_arr[2], qgtmp_arr[2], hdt, cdtdz);
+                        trans_single(tyzbx, 2, 1, qym_arr, qmyz.array(), qyp_arr, qpyz.array(),
+                                     qaux_arr, ftmp_arr[2], qgtmp_arr[2], hdt, cdtdz);
+
+                        reset_edge_state_thermo(tyxbx, qmyx.array());
+                        reset_edge_state_thermo(tyxbx, qpyx.array());
+                        reset_edge_state_thermo(tzxbx, qmzx.array());
+                        reset_edge_state_thermo(tzxbx, qpzx.array());
+                        reset_edge_state_thermo(txybx, qmxy.array());
+                        reset_edge_state_thermo(txybx, qpxy.array());
+                        reset_edge_state_thermo(tzybx, qmzy.array());
+                        reset_edge_state_thermo(tzybx, qpzy.array());
+                        reset_edge_state_thermo(txzbx, qmxz.array());
+                        reset_edge_state_thermo(txzbx, qpxz.array());
+                        reset_edge_state_thermo(tyzbx, qmyz.array());
+                        reset_edge_state_thermo(tyzbx, qpyz.array());
+                    });
+
+                    // the final fluxes in each direction
+
+                    fc1.resize(obx, NUM_STATE);
+                    fc2.resize(obx, NUM_STATE);
+                    qgc1.resize(obx, NGDNV);
+                    qgc2.resize(obx, NGDNV);
+                    ql.resize(obx, NQ);
+                    qr.resize(obx, NQ);
+
+                    auto fc1_arr = fc1.array();
+                    auto fc2_arr = fc2.array();
+                    auto qgc1_arr = qgc1.array();
+                    auto qgc2_arr = qgc2.array();
+                    auto ql_arr = ql.array();
+                    auto qr_arr = qr.array();
+
+                    flux[0].resize(amrex::grow(xbx, 1), NUM_STATE);
+                    flux[1].resize(amrex::grow(ybx, 1), NUM_STATE);
+                    flux[2].resize(amrex::grow(zbx, 1), NUM_STATE);
+                    qe[0].resize(amrex::grow(xbx, 1), NGDNV);
+                    qe[1].resize(amrex::grow(ybx, 1), NGDNV);
+                    qe[2].resize(amrex::grow(zbx, 1), NGDNV);
+
+                    // for each direction: the two corner coupled
+                    // fluxes, the final transverse update, and the
+                    // final Riemann solve
+
+                    struct FinalSolve {
+                        Box ntbx;
+                        int idir_n, idir_t1, idir_t2;
+                        Box c1bx, c2bx;
+                        Array4<Real> qm1, qp1, qm2, qp2;
+                        Array4<Real const> qnm, qnp;
+                        Real cdt1, cdt2;
+                    };
+
+                    const FinalSolve final_solves[3] = {
+                        {xbx, 0, 1, 2,
+                         amrex::grow(ybx, IntVect(1,0,0)), amrex::grow(zbx, IntVect(1,0,0)),
+                         qmyz.array(), qpyz.array(), qmzy.array(), qpzy.array(),
+                         qxm_arr, qxp_arr, hdtdy, hdtdz},
+                        {ybx, 1, 0, 2,
+                         amrex::grow(xbx, IntVect(0,1,0)), amrex::grow(zbx, IntVect(0,1,0)),
+                         qmxz.array(), qpxz.array(), qmzx.array(), qpzx.array(),
+                         qym_arr, qyp_arr, hdtdx, hdtdz},
+                        {zbx, 2, 0, 1,
+                         amrex::grow(xbx, IntVect(0,0,1)), amrex::grow(ybx, IntVect(0,0,1)),
+                         qmxy.array(), qpxy.array(), qmyx.array(), qpyx.array(),
+                         qzm_arr, qzp_arr, hdtdx, hdtdy}
+                    };
+
+                    for (const auto& fs : final_solves) {
+
+                        timed(cmpflx_stage, [&] () {
+                            cmpflx_plus_godunov(fs.c1bx, fs.qm1, fs.qp1, fc1_arr, qgc1_arr,
+                                                qaux_arr, shk_arr, fs.idir_t1, false);
+                            cmpflx_plus_godunov(fs.c2bx, fs.qm2, fs.qp2, fc2_arr, qgc2_arr,
+                                                qaux_arr, shk_arr, fs.idir_t2, false);
+                        });
+
+                        timed(trans_final_stage, [&] () {
+                            trans_final(fs.ntbx, fs.idir_n, fs.idir_t1, fs.idir_t2,
+                                        fs.qnm, ql_arr, fs.qnp, qr_arr,
+                                        qaux_arr,
+                                        fc1_arr, fc2_arr,
+                                        qgc1_arr, qgc2_arr,
+                                        fs.cdt1, fs.cdt2);
+                            reset_edge_state_thermo(fs.ntbx, ql_arr);
+                            reset_edge_state_thermo(fs.ntbx, qr_arr);
+                        });
+
+                        timed(cmpflx_stage, [&] () {
+                            cmpflx_plus_godunov(fs.ntbx, ql_arr, qr_arr,
+                                                flux[fs.idir_n].array(), qe[fs.idir_n].array(),
+                                                qaux_arr, shk_arr, fs.idir_n, false);
+                        });
+                    }
+
+                    // the conservative update
+
+                    Array4<Real> const update_arr = U_update.array(mfi);
+
+                    timed(consup_hydro_stage, [&] () {
+                        consup_hydro(bx,
+#ifdef SHOCK_VAR
+                                     shk_arr,
+#endif
+                                     update_arr,
+                                     flux[0].array(), qe[0].array(),
+                                     flux[1].array(), qe[1].array(),
+                                     flux[2].array(), qe[2].array(),
+                                     dt);
+                    });
+
+                    // the method-of-lines reconstruction and update,
+                    // reusing the fluxes from above.  The MOL
+                    // reconstruction works on all NQ primitive
+                    // variables, so we need the passives in q too (this
+                    // conversion is not timed)
+
+                    q_full.resize(qbx, NQ);
+                    ctoprim(qbx, time, U_arr, q_full.array(), qaux_arr);
+
+                    const Box& tbx = amrex::grow(bx, 2);
+                    ql.resize(tbx, NQ);
+                    qr.resize(tbx, NQ);
+
+                    timed(mol_ppm_reconstruct_stage, [&] () {
+                        for (int idir = 0; idir < 3; ++idir) {
+                            mol_ppm_reconstruct(obx, idir,
+                                                q_full.array(), flatn_arr,
+                                                ql.array(), qr.array());
+                        }
+                    });
+
+                    srcU.resize(bx, NUM_STATE);
+                    srcU.setVal<RunOn::Device>(0.0);
+
+                    timed(mol_consup_stage, [&] () {
+                        mol_consup(bx,
+#ifdef SHOCK_VAR
+                                   shk_arr,
+#endif
+                                   srcU.array(),
+                                   update_arr,
+                                   dt,
+                                   flux[0].array(), flux[1].array(), flux[2].array(),
+                                   area[0].array(mfi), area[1].array(mfi), area[2].array(mfi),
+                                   volume.array(mfi));
+                    });
+                }
+
+                Gpu::streamSynchronize();
+                my_time[num_stages] += amrex::second() - loop_start;
+
+            } // omp parallel
+
+            Real rep_time = amrex::second() - wall_start;
+            ParallelDescriptor::ReduceRealMax(rep_time);
+            wall_time += rep_time;
+
+            } // rep loop
+
+            // The stages of a tile run back to back on one thread, so
+            // only the pipeline as a whole has a wall clock time.  We
+            // split it between the stages by their share of the time
+            // summed over the threads (and ranks), which includes the
+            // untimed work between the stages.
+
+            Vector<Real> total_time(num_stages + 1, 0.0_rt);
+            for (int n = 0; n <= num_stages; ++n) {
+                for (int t = 0; t < max_threads; ++t) {
+                    total_time[n] += stage_time[t * (num_stages + 1) + n];
+                }
+            }
+
+            ParallelDescriptor::ReduceRealSum(total_time.dataPtr(), num_stages + 1);
+
+            const Real loop_time = amrex::max(total_time[num_stages], std::numeric_limits<Real>::min());
+
+            amrex::Print() << std::endl << "  tile size = " << tile_size
+                           << ", threads = " << nthreads << std::endl;
+
+            for (int n = 0; n <= num_stages; ++n) {
+
+                const std::string name = n < num_stages ? stage_names[n] : "total";
+                const Real share = total_time[n] / loop_time;
+                const Real ns_per_zone = 1.e9_rt * share * wall_time / (nzones * nreps);
+
+                amrex::Print() << "    " << std::setw(24) << std::left << name
+                               << std::setw(14) << std::right << std::setprecision(6) << ns_per_zone
+                               << " ns / zone" << std::endl;
+
+                if (ParallelDescriptor::IOProcessor()) {
+                    ofile << name << "," << tile_size << "," << nthreads << ","
+                          << NUM_STATE << "," << grids.numPts() << "," << nreps << ","
+                          << std::setprecision(8) << total_time[n] << "," << share << ","
+                          << ns_per_zone << std::endl;
+                }
+            }
+        }
+    }
+
+    if (ParallelDescriptor::IOProcessor()) {
+        ofile.close();
+    }
+
+    amrex::Print() << std::endl << "benchmark results written to " << output_file << std::endl;
+
+#endif
+
+}
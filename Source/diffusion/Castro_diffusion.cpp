@@ -99,77 +99,323 @@ Castro::getTempDiffusionTerm (Real time, MultiFab& state_in, MultiFab& TempDiffT
 {
     BL_PROFILE("Castro::getTempDiffusionTerm()");
 
-   // Fill coefficients at this level.
-   Vector<std::unique_ptr<MultiFab> > coeffs(AMREX_SPACEDIM);
-   for (int dir = 0; dir < AMREX_SPACEDIM; ++dir) {
-       coeffs[dir] = std::make_unique<MultiFab>(getEdgeBoxArray(dir), dmap, 1, 0);
-   }
+    amrex::ignore_unused(state_in);
 
-   // Fill temperature at this level.
-   MultiFab Temperature(grids, dmap, 1, 1);
+    // The old-time state does not change during an advance, so if we
+    // already have the conductivity and temperature at the old time
+    // (e.g. from the predictor, when we are now time-centering the
+    // source) we can reuse them.  At any other time the state may have
+    // changed since we last filled them, so we start over.
 
-   {
-       FillPatchIterator fpi(*this, state_in, 1, time, State_Type, 0, NUM_STATE);
-       MultiFab& grown_state = fpi.get_mf();
+    const Real prev_time = state[State_Type].prevTime();
+    const Real cur_time = state[State_Type].curTime();
+    const Real teps = 1.e-3_rt * (cur_time - prev_time);
 
-       MultiFab::Copy(Temperature, grown_state, UTEMP, 0, 1, 1);
+    const bool is_old_time = cur_time > prev_time && std::abs(time - prev_time) < teps;
+
+    if (!(is_old_time && temp_diff_data_is_old && std::abs(time - temp_diff_data_time) < teps)) {
+        fill_temp_diffusion_data(time);
+
+        temp_diff_data_time = time;
+        temp_diff_data_is_old = is_old_time;
+    }
+
+    diffusion->applyop(level, temp_diff_T, temp_diff_crse_T, TempDiffTerm, temp_cond_coeffs);
+
+}
+
+
+void
+Castro::fill_temp_diffusion_data (Real time)
+{
+    BL_PROFILE("Castro::fill_temp_diffusion_data()");
+
+    if (temp_cond_coeffs.empty()) {
+        temp_cond_coeffs.resize(AMREX_SPACEDIM);
+        for (int dir = 0; dir < AMREX_SPACEDIM; ++dir) {
+            temp_cond_coeffs[dir] = std::make_unique<MultiFab>(getEdgeBoxArray(dir), dmap, 1, 0);
+        }
+
+        temp_diff_T.define(grids, dmap, 1, 1);
+    }
+
+    // The conductivity only depends on the density, temperature,
+    // internal energy, and composition, but we fill the whole state:
+    // the physical boundary fill (HSE, ambient, and problem-specific
+    // boundaries) needs all of the components.
+
+    MultiFab grown_state(grids, dmap, NUM_STATE, 1);
+
+    AmrLevel::FillPatch(*this, grown_state, 1, time, State_Type, 0, NUM_STATE);
+
+    MultiFab::Copy(temp_diff_T, grown_state, UTEMP, 0, 1, 1);
 
 #ifdef _OPENMP
 #pragma omp parallel
 #endif
-       {
-           FArrayBox coeff_cc;
+    {
+        FArrayBox coeff_cc;
+
+        for (MFIter mfi(grown_state, TilingIfNotGPU()); mfi.isValid(); ++mfi)
+        {
+
+            const Box& bx = mfi.tilebox();
+
+            // Create an array for storing cell-centered conductivity data.
+            // It needs to have a ghost zone for the next step.
+
+            const Box& obx = amrex::grow(bx, 1);
+            coeff_cc.resize(obx, 1);
+            Elixir elix_coeff_cc = coeff_cc.elixir();
+            Array4<Real> const coeff_arr = coeff_cc.array();
+
+            Array4<Real const> const U_arr = grown_state.array(mfi);
+
+            fill_temp_cond(obx, U_arr, coeff_arr);
+
+            for (int idir = 0; idir < AMREX_SPACEDIM; ++idir) {
 
-           for (MFIter mfi(grown_state, TilingIfNotGPU()); mfi.isValid(); ++mfi)
-           {
+                const Box& nbx = amrex::surroundingNodes(bx, idir);
 
-               const Box& bx = mfi.tilebox();
+                Array4<Real> const edge_coeff_arr = (*temp_cond_coeffs[idir]).array(mfi);
+
+                AMREX_PARALLEL_FOR_3D(nbx, i, j, k,
+                {
+
+                  if (idir == 0) {
+                    edge_coeff_arr(i,j,k) = 0.5_rt * (coeff_arr(i,j,k) + coeff_arr(i-1,j,k));
+                  } else if (idir == 1) {
+                    edge_coeff_arr(i,j,k) = 0.5_rt * (coeff_arr(i,j,k) + coeff_arr(i,j-1,k));
+                  } else {
+                    edge_coeff_arr(i,j,k) = 0.5_rt * (coeff_arr(i,j,k) + coeff_arr(i,j,k-1));
+                  }
+                });
+            }
+        }
+    }
+
+    if (level > 0) {
+        // Fill temperature at next coarser level, if it exists.
+        const BoxArray& crse_grids = getLevel(level-1).boxArray();
+        const DistributionMapping& crse_dmap = getLevel(level-1).DistributionMap();
+        if (!temp_diff_crse_T.ok() ||
+            temp_diff_crse_T.boxArray() != crse_grids ||
+            temp_diff_crse_T.DistributionMap() != crse_dmap) {
+            temp_diff_crse_T.define(crse_grids, crse_dmap, 1, 1);
+        }
+        FillPatch(getLevel(level-1), temp_diff_crse_T, 1, time, State_Type, UTEMP, 1);
+    }
+
+}
+
+
+advance_status
+Castro::do_split_temp_diffusion (Real time, Real dt)
+{
+    BL_PROFILE("Castro::do_split_temp_diffusion()");
+
+    advance_status status {};
+
+    const Real strt_time = ParallelDescriptor::second();
+
+    MultiFab& S_new = get_new_data(State_Type);
+
+    // We diffuse the temperature at fixed density and composition,
+    // holding rho c_v and the conductivity at their values at the
+    // start of the diffusion update, so the change in the internal
+    // energy is rho c_v (T^{n+1} - T^*).
+
+    fill_temp_diffusion_data(time);
+
+    temp_diff_data_time = time;
+    temp_diff_data_is_old = false;
+
+    MultiFab rhocv(grids, dmap, 1, 0);
+
+#ifdef _OPENMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+    for (MFIter mfi(rhocv, TilingIfNotGPU()); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = mfi.tilebox();
+
+        fill_temp_rhocv(bx, S_new.array(mfi), rhocv.array(mfi));
+    }
 
-               // Create an array for storing cell-centered conductivity data.
-               // It needs to have a ghost zone for the next step.
+    // The updated temperature.  The ghost cells keep the values at the
+    // start of the update, for the boundary conditions.
 
-               const Box& obx = amrex::grow(bx, 1);
-               coeff_cc.resize(obx, 1);
-               Elixir elix_coeff_cc = coeff_cc.elixir();
-               Array4<Real> const coeff_arr = coeff_cc.array();
+    MultiFab T_new(grids, dmap, 1, 1);
+    MultiFab::Copy(T_new, temp_diff_T, 0, 0, 1, 1);
 
-               Array4<Real const> const U_arr = grown_state.array(mfi);
+    MultiFab LT_old(grids, dmap, 1, 0);
 
-               fill_temp_cond(obx, U_arr, coeff_arr);
+    if (diffusion_method == 1) {
 
-               for (int idir = 0; idir < AMREX_SPACEDIM; ++idir) {
+        // theta-method: rho c_v (T^{n+1} - T^*) = dt [theta L(T^{n+1}) + (1 - theta) L(T^*)]
 
-                   const Box& nbx = amrex::surroundingNodes(bx, idir);
+        MultiFab rhs(grids, dmap, 1, 0);
+        MultiFab::Copy(rhs, temp_diff_T, 0, 0, 1, 0);
+        MultiFab::Multiply(rhs, rhocv, 0, 0, 1, 0);
 
-                   Array4<Real> const edge_coeff_arr = (*coeffs[idir]).array(mfi);
+        if (diffusion_theta < 1.0_rt) {
+            diffusion->applyop(level, temp_diff_T, temp_diff_crse_T, LT_old, temp_cond_coeffs);
+            MultiFab::Saxpy(rhs, (1.0_rt - diffusion_theta) * dt, LT_old, 0, 0, 1, 0);
+        }
 
-                   AMREX_PARALLEL_FOR_3D(nbx, i, j, k,
-                   {
+        diffusion->solve_temp_implicit(level, diffusion_theta * dt, T_new, temp_diff_crse_T,
+                                       rhs, rhocv, temp_cond_coeffs);
 
-                     if (idir == 0) {
-                       edge_coeff_arr(i,j,k) = 0.5_rt * (coeff_arr(i,j,k) + coeff_arr(i-1,j,k));
-                     } else if (idir == 1) {
-                       edge_coeff_arr(i,j,k) = 0.5_rt * (coeff_arr(i,j,k) + coeff_arr(i,j-1,k));
-                     } else {
-                       edge_coeff_arr(i,j,k) = 0.5_rt * (coeff_arr(i,j,k) + coeff_arr(i,j,k-1));
-                     }
-                   });
-               }
-           }
-       }
+    } else {
 
-   }
+        // RKL2 super-time-stepping (Meyer, Balsara, & Aslam 2014, JCP,
+        // 257, 594) on Y = rho c_v T.  Each stage is a linear
+        // combination of flux divergences, so the update is
+        // conservative.  The explicit limit here is the forward Euler
+        // one, dx**2 / (2 d D); if the step needs more than
+        // diffusion_rkl2_max_stages stages we split it into substeps.
 
-   MultiFab CrseTemp;
+        auto diffuse_dt = estdt_temp_diffusion(1);
+        ParallelAllReduce::Min(diffuse_dt, MPI_COMM_WORLD);
 
-   if (level > 0) {
-       // Fill temperature at next coarser level, if it exists.
-       const BoxArray& crse_grids = getLevel(level-1).boxArray();
-       const DistributionMapping& crse_dmap = getLevel(level-1).DistributionMap();
-       CrseTemp.define(crse_grids,crse_dmap,1,1);
-       FillPatch(getLevel(level-1),CrseTemp,1,time,State_Type,UTEMP,1);
-   }
+        const Real dt_explicit = rkl2_explicit_dt(diffuse_dt.value);
+        const Real dt_super_max = rkl2_max_dt(diffuse_dt.value, diffusion_rkl2_max_stages);
 
-   diffusion->applyop(level, Temperature, CrseTemp, TempDiffTerm, coeffs);
+        const int nsub = amrex::max(1, static_cast<int>(std::ceil(dt / dt_super_max)));
+        const Real dt_sub = dt / static_cast<Real>(nsub);
+
+        const Real ratio = dt_sub / dt_explicit;
+        const int nstages = amrex::min(diffusion_rkl2_max_stages,
+                                       amrex::max(2, static_cast<int>(std::ceil(0.5_rt * (std::sqrt(9.0_rt + 16.0_rt * ratio) - 1.0_rt)))));
+
+        if (verbose > 0) {
+            amrex::Print() << "... RKL2 thermal diffusion at level " << level << ": "
+                           << nsub << " substep(s) of " << nstages << " stages" << std::endl;
+        }
+
+        auto b_coeff = [] (int j) -> Real
+        {
+            if (j <= 2) {
+                return 1.0_rt / 3.0_rt;
+            }
+            const Real jr = static_cast<Real>(j);
+            return (jr * jr + jr - 2.0_rt) / (2.0_rt * jr * (jr + 1.0_rt));
+        };
+
+        const Real sr = static_cast<Real>(nstages);
+        const Real w1 = 4.0_rt / (sr * sr + sr - 2.0_rt);
+
+        MultiFab Y0(grids, dmap, 1, 0);
+        MultiFab Y_jm1(grids, dmap, 1, 0);
+        MultiFab Y_jm2(grids, dmap, 1, 0);
+        MultiFab LT(grids, dmap, 1, 0);
+
+        for (int isub = 0; isub < nsub; ++isub) {
+
+            // Y_0 = rho c_v T and Y_1 = Y_0 + mu~_1 dt L(Y_0)
+
+            MultiFab::Copy(Y0, T_new, 0, 0, 1, 0);
+            MultiFab::Multiply(Y0, rhocv, 0, 0, 1, 0);
+
+            diffusion->applyop(level, T_new, temp_diff_crse_T, LT_old, temp_cond_coeffs);
+
+            MultiFab::Copy(Y_jm2, Y0, 0, 0, 1, 0);
+            MultiFab::LinComb(Y_jm1, 1.0_rt, Y0, 0, w1 * b_coeff(1) * dt_sub, LT_old, 0, 0, 1, 0);
+
+            for (int j = 2; j <= nstages; ++j) {
+
+                const Real jr = static_cast<Real>(j);
+
+                const Real mu = (2.0_rt * jr - 1.0_rt) / jr * b_coeff(j) / b_coeff(j-1);
+                const Real nu = -(jr - 1.0_rt) / jr * b_coeff(j) / b_coeff(j-2);
+                const Real mu_t = mu * w1 * dt_sub;
+                const Real gamma_t = -(1.0_rt - b_coeff(j-1)) * mu_t;
+
+                // T_{j-1} = Y_{j-1} / (rho c_v)
+
+                MultiFab::Copy(T_new, Y_jm1, 0, 0, 1, 0);
+                MultiFab::Divide(T_new, rhocv, 0, 0, 1, 0);
+
+                diffusion->applyop(level, T_new, temp_diff_crse_T, LT, temp_cond_coeffs);
+
+#ifdef _OPENMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+                for (MFIter mfi(Y0, TilingIfNotGPU()); mfi.isValid(); ++mfi)
+                {
+                    const Box& bx = mfi.tilebox();
+
+                    auto Y0_arr = Y0.array(mfi);
+                    auto Y_jm1_arr = Y_jm1.array(mfi);
+                    auto Y_jm2_arr = Y_jm2.array(mfi);
+                    auto LT_arr = LT.array(mfi);
+                    auto LT_old_arr = LT_old.array(mfi);
+
+                    amrex::ParallelFor(bx,
+                    [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+                    {
+                        // Y_j overwrites Y_{j-2}, which we no longer need
+                        Y_jm2_arr(i,j,k) = mu * Y_jm1_arr(i,j,k) + nu * Y_jm2_arr(i,j,k) +
+                                           (1.0_rt - mu - nu) * Y0_arr(i,j,k) +
+                                           mu_t * LT_arr(i,j,k) + gamma_t * LT_old_arr(i,j,k);
+                    });
+                }
+
+                std::swap(Y_jm1, Y_jm2);
+            }
+
+            MultiFab::Copy(T_new, Y_jm1, 0, 0, 1, 0);
+            MultiFab::Divide(T_new, rhocv, 0, 0, 1, 0);
+        }
+
+    }
+
+    // Update the energy.  The temperature change is with respect to
+    // the start of the diffusion update, which is in temp_diff_T.
+
+#ifdef _OPENMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+    for (MFIter mfi(S_new, TilingIfNotGPU()); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = mfi.tilebox();
+
+        auto S_arr = S_new.array(mfi);
+        auto rhocv_arr = rhocv.array(mfi);
+        auto T_old_arr = temp_diff_T.array(mfi);
+        auto T_new_arr = T_new.array(mfi);
+
+        amrex::ParallelFor(bx,
+        [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+        {
+            Real dE = rhocv_arr(i,j,k) * (T_new_arr(i,j,k) - T_old_arr(i,j,k));
+
+            S_arr(i,j,k,UEINT) += dE;
+            S_arr(i,j,k,UEDEN) += dE;
+        });
+    }
+
+    computeTemp(
+#ifdef MHD
+                get_new_data(Mag_Type_x), get_new_data(Mag_Type_y), get_new_data(Mag_Type_z),
+#endif
+                S_new, time, S_new.nGrow());
+
+    if (verbose > 1)
+    {
+        const int IOProc   = ParallelDescriptor::IOProcessorNumber();
+        Real      run_time = ParallelDescriptor::second() - strt_time;
+
+#ifdef BL_LAZY
+        Lazy::QueueReduction( [=] () mutable {
+#endif
+        ParallelDescriptor::ReduceRealMax(run_time,IOProc);
+
+        amrex::Print() << "Castro::do_split_temp_diffusion() time = " << run_time << " on level " << level << "\n" << "\n";
+#ifdef BL_LAZY
+        });
+#endif
+    }
 
+    return status;
 }
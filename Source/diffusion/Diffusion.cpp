@@ -16,7 +16,9 @@ Diffusion::Diffusion(Amr* Parent, BCRec* _phys_bc)
     grids(MAX_LEV),
     volume(MAX_LEV),
     area(MAX_LEV),
-    phys_bc(_phys_bc)
+    phys_bc(_phys_bc),
+    mlabec(MAX_LEV),
+    mlabec_solve(MAX_LEV)
 {
     AMREX_ALWAYS_ASSERT(parent->maxLevel() < MAX_LEV);
 
@@ -49,6 +51,11 @@ Diffusion::install_level (int                   level,
 
     BoxArray ba(LevelData[level]->boxArray());
     grids[level] = ba;
+
+    // the grids (may) have changed, so the operator needs to be rebuilt
+
+    mlabec[level].reset();
+    mlabec_solve[level].reset();
 }
 
 void
@@ -141,29 +148,84 @@ Diffusion::applyop_mlmg (int level, MultiFab& Temperature,
     const BoxArray& ba = Temperature.boxArray();
     const DistributionMapping& dm = Temperature.DistributionMap();
 
-    LPInfo info;
-    info.setMetricTerm(true);
-    info.setMaxCoarseningLevel(0);
-    info.setAgglomeration(false);
-    info.setConsolidation(false);
+    if (mlabec[level] == nullptr) {
+
+        LPInfo info;
+        info.setMetricTerm(true);
+        info.setMaxCoarseningLevel(0);
+        info.setAgglomeration(false);
+        info.setConsolidation(false);
+
+        mlabec[level] = std::make_unique<MLABecLaplacian>(Vector<Geometry>{geom},
+                                                          Vector<BoxArray>{ba},
+                                                          Vector<DistributionMapping>{dm},
+                                                          info);
+        mlabec[level]->setMaxOrder(diffusion::mlmg_maxorder);
 
-    MLABecLaplacian mlabec({geom}, {ba}, {dm}, info);
-    mlabec.setMaxOrder(diffusion::mlmg_maxorder);
+        mlabec[level]->setDomainBC(mlmg_lobc, mlmg_hibc);
 
-    mlabec.setDomainBC(mlmg_lobc, mlmg_hibc);
+        mlabec[level]->setScalars(0.0, -1.0);
+    }
 
     if (level > 0) {
         const auto& rr = parent->refRatio(level-1);
-        mlabec.setCoarseFineBC(&CrseTemp, rr[0]);
+        mlabec[level]->setCoarseFineBC(&CrseTemp, rr[0]);
     }
-    mlabec.setLevelBC(0, &Temperature);
+    mlabec[level]->setLevelBC(0, &Temperature);
 
-    mlabec.setScalars(0.0, -1.0);
-    mlabec.setBCoeffs(0, Array<MultiFab const*, AMREX_SPACEDIM>{AMREX_D_DECL(temp_cond_coef[0].get(),
-                                                                             temp_cond_coef[1].get(),
-                                                                             temp_cond_coef[2].get())});
+    mlabec[level]->setBCoeffs(0, Array<MultiFab const*, AMREX_SPACEDIM>{AMREX_D_DECL(temp_cond_coef[0].get(),
+                                                                                     temp_cond_coef[1].get(),
+                                                                                     temp_cond_coef[2].get())});
 
-    MLMG mlmg(mlabec);
+    MLMG mlmg(*mlabec[level]);
     mlmg.setVerbose(verbose);
     mlmg.apply({&DiffTerm}, {&Temperature});
 }
+
+void
+Diffusion::solve_temp_implicit (int level, Real b, MultiFab& Temperature,
+                                MultiFab& CrseTemp, MultiFab& rhs,
+                                const MultiFab& rhocv,
+                                Vector<std::unique_ptr<MultiFab> >& temp_cond_coef)
+{
+    BL_PROFILE("Diffusion::solve_temp_implicit()");
+
+    if (verbose && ParallelDescriptor::IOProcessor()) {
+        std::cout << "   " << '\n';
+        std::cout << "... implicit thermal diffusion solve at level " << level << '\n';
+    }
+
+    const Geometry& geom = parent->Geom(level);
+    const BoxArray& ba = Temperature.boxArray();
+    const DistributionMapping& dm = Temperature.DistributionMap();
+
+    if (mlabec_solve[level] == nullptr) {
+
+        LPInfo info;
+        info.setMetricTerm(true);
+
+        mlabec_solve[level] = std::make_unique<MLABecLaplacian>(Vector<Geometry>{geom},
+                                                                Vector<BoxArray>{ba},
+                                                                Vector<DistributionMapping>{dm},
+                                                                info);
+        mlabec_solve[level]->setMaxOrder(diffusion::mlmg_maxorder);
+
+        mlabec_solve[level]->setDomainBC(mlmg_lobc, mlmg_hibc);
+    }
+
+    if (level > 0) {
+        const auto& rr = parent->refRatio(level-1);
+        mlabec_solve[level]->setCoarseFineBC(&CrseTemp, rr[0]);
+    }
+    mlabec_solve[level]->setLevelBC(0, &Temperature);
+
+    mlabec_solve[level]->setScalars(1.0, b);
+    mlabec_solve[level]->setACoeffs(0, rhocv);
+    mlabec_solve[level]->setBCoeffs(0, Array<MultiFab const*, AMREX_SPACEDIM>{AMREX_D_DECL(temp_cond_coef[0].get(),
+                                                                                           temp_cond_coef[1].get(),
+                                                                                           temp_cond_coef[2].get())});
+
+    MLMG mlmg(*mlabec_solve[level]);
+    mlmg.setVerbose(verbose);
+    mlmg.solve({&Temperature}, {&rhs}, diffusion::implicit_rtol, diffusion::implicit_atol);
+}
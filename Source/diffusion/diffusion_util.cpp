@@ -107,3 +107,53 @@ fill_temp_diff_coeff(const Box& bx,
   });
 }
 
+
+void
+fill_temp_rhocv(const Box& bx,
+                Array4<Real const> const& U_arr,
+                Array4<Real> const& rhocv_arr) {
+
+  amrex::ParallelFor(bx,
+  [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+  {
+
+    eos_t eos_state;
+    eos_state.rho  = U_arr(i,j,k,URHO);
+    Real rhoinv = 1.0_rt/eos_state.rho;
+
+    eos_state.T = U_arr(i,j,k,UTEMP);   // needed as an initial guess
+    eos_state.e = U_arr(i,j,k,UEINT) * rhoinv;
+    for (int n = 0; n < NumSpec; n++) {
+      eos_state.xn[n] = U_arr(i,j,k,UFS+n) * rhoinv;
+    }
+#if NAUX_NET > 0
+    for (int n = 0; n < NumAux; n++) {
+      eos_state.aux[n] = U_arr(i,j,k,UFX+n) * rhoinv;
+    }
+#endif
+
+    if (eos_state.e < 0.0_rt) {
+      eos_state.T = castro::small_temp;
+      eos(eos_input_rt, eos_state);
+    } else {
+      eos(eos_input_re, eos_state);
+    }
+
+    rhocv_arr(i,j,k) = eos_state.rho * eos_state.cv;
+
+  });
+}
+
+Real
+rkl2_explicit_dt(Real diffuse_dt) {
+
+  return diffuse_dt / static_cast<Real>(AMREX_SPACEDIM);
+}
+
+Real
+rkl2_max_dt(Real diffuse_dt, int max_stages) {
+
+  const Real s = static_cast<Real>(max_stages);
+
+  return 0.25_rt * (s * s + s - 2.0_rt) * rkl2_explicit_dt(diffuse_dt);
+}
@@ -9,14 +9,17 @@
 #include <vector>
 #include <iostream>
 #include <string>
+#include <sstream>
 #include <ctime>
 #include <memory>
+#include <limits>
 
 #include <AMReX_Utility.H>
 #include <AMReX_CONSTANTS.H>
 #include <Castro.H>
 #include <global.H>
 #include <runtime_parameters.H>
+#include <riemann.H>
 #include <AMReX_VisMF.H>
 #include <AMReX_TagBox.H>
 #include <AMReX_FillPatchUtil.H>
@@ -32,10 +35,12 @@
 
 #ifdef GRAVITY
 #include <Gravity.H>
+#include <Castro_bc_fill_nd.H>
 #endif
 
 #ifdef DIFFUSION
 #include <Diffusion.H>
+#include <diffusion_util.H>
 #endif
 
 #ifdef AMREX_USE_OMP
@@ -80,11 +85,13 @@ Real         Castro::num_zones_advanced = 0.0;
 
 Vector<std::string> Castro::source_names;
 
-Vector<AMRErrorTag> Castro::error_tags;
+Vector<tagging::Indicator> Castro::tag_indicators;
 
 Vector<std::unique_ptr<std::fstream>> Castro::data_logs;
 Vector<std::unique_ptr<std::fstream>> Castro::problem_data_logs;
 
+ReductionQueue Castro::diagnostics_reductions;
+
 #ifdef TRUE_SDC
 int          Castro::SDC_NODES;
 Vector<Real> Castro::dt_sdc;
@@ -144,6 +151,7 @@ Real         Castro::previousCPUTimeUsed = 0.0;
 Real         Castro::startCPUTime = 0.0;
 
 int          Castro::SDC_Source_Type = -1;
+int          Castro::Work_Estimate_Type = -1;
 int          Castro::num_state_type = 0;
 
 int          Castro::do_cxx_prob_initialize = 0;
@@ -189,6 +197,10 @@ Castro::variableCleanUp ()
 #endif
 
 #ifdef AMREX_PARTICLES
+  // this writes out anything still buffered
+  delete TracerHistory;
+  TracerHistory = nullptr;
+
   delete TracerPC;
   TracerPC = 0;
 #endif
@@ -347,6 +359,12 @@ Castro::read_params ()
     if (time_integration_method == SpectralDeferredCorrections) {
         amrex::Error("SDC is currently not enabled on GPUs.");
     }
+
+    // The uniform composition check needs a reduction (and so a device
+    // synchronization) for every box, which costs more than it saves.
+    if (uniform_composition_tol >= 0.0) {
+        amrex::Error("castro.uniform_composition_tol is not supported on GPUs.");
+    }
 #endif
 
 
@@ -368,12 +386,40 @@ Castro::read_params ()
     if (time_integration_method == SpectralDeferredCorrections) {
         amrex::Error("True SDC currently requires USE_TRUE_SDC=TRUE when compiling.");
     }
+
+    // the low storage Runge-Kutta integrator uses the method of lines
+    // hydro source, which is built with the true SDC machinery
+    if (time_integration_method == LowStorageRungeKutta) {
+        amrex::Error("The low storage Runge-Kutta integrator requires USE_TRUE_SDC=TRUE when compiling.");
+    }
 #else
-    if (time_integration_method != SpectralDeferredCorrections) {
-        amrex::Error("When building with USE_TRUE_SDC=TRUE, only true SDC can be used.");
+    if (time_integration_method != SpectralDeferredCorrections &&
+        time_integration_method != LowStorageRungeKutta) {
+        amrex::Error("When building with USE_TRUE_SDC=TRUE, only true SDC or the low storage Runge-Kutta integrator can be used.");
     }
 #endif
 
+    if (time_integration_method == LowStorageRungeKutta) {
+        if (lsrk_order < 2 || lsrk_order > 4) {
+            amrex::Error("castro.lsrk_order must be 2, 3, or 4.");
+        }
+
+        if (sdc_order != 2) {
+            amrex::Error("The low storage Runge-Kutta integrator only supports the second order reconstruction (castro.sdc_order = 2).");
+        }
+
+#ifdef MHD
+        amrex::Error("The low storage Runge-Kutta integrator does not support MHD.");
+#endif
+
+#ifdef REACTIONS
+        // there is no coupling of the burn to the stages
+        if (do_react) {
+            amrex::Error("The low storage Runge-Kutta integrator does not support reactions (castro.do_react = 0).");
+        }
+#endif
+    }
+
 #ifndef AMREX_USE_GPU
 
 #ifdef RADIATION
@@ -468,6 +514,25 @@ Castro::read_params ()
     }
 #endif
 
+#ifdef DIFFUSION
+    // the operator-split diffusion options are only supported with CTU
+    if (diffuse_temp && diffusion_method != 0 && time_integration_method != CornerTransportUpwind) {
+        amrex::Error("castro.diffusion_method = 1 or 2 is currently only supported for CTU time advancement.");
+    }
+
+    if (diffusion_method < 0 || diffusion_method > 2) {
+        amrex::Error("castro.diffusion_method must be 0, 1, or 2.");
+    }
+
+    if (diffusion_method == 1 && (diffusion_theta < 0.5_rt || diffusion_theta > 1.0_rt)) {
+        amrex::Error("castro.diffusion_theta must be between 0.5 and 1.");
+    }
+
+    if (diffusion_method == 2 && diffusion_rkl2_max_stages < 2) {
+        amrex::Error("castro.diffusion_rkl2_max_stages must be at least 2.");
+    }
+#endif
+
 #ifdef ROTATION
     if (do_rotation == 1) {
       if (rotational_period <= 0.0) {
@@ -569,6 +634,13 @@ Castro::read_params ()
 
     Amr::setComputeNewDtOnRegrid(1);
 
+    // Distribute the boxes with our measured costs when regridding
+    // (see WorkEstType).
+
+    if (load_balance_with_costs && !ppa.contains("loadbalance_with_workestimates")) {
+        ppa.add("loadbalance_with_workestimates", 1);
+    }
+
     // Read in custom refinement scheme.
 
     Vector<std::string> refinement_indicators;
@@ -579,65 +651,47 @@ Castro::read_params ()
 
         ParmParse ppr(ref_prefix);
 
-        AMRErrorTagInfo info;
+        tagging::Indicator ind;
+        ind.name = ref_indicator;
 
-        if (ppr.countval("start_time") > 0) {
-            Real min_time;
-            ppr.get("start_time", min_time);
-            info.SetMinTime(min_time);
-        }
-        if (ppr.countval("end_time") > 0) {
-            Real max_time;
-            ppr.get("end_time", max_time);
-            info.SetMaxTime(max_time);
-        }
-        if (ppr.countval("max_level") > 0) {
-            int max_level;
-            ppr.get("max_level", max_level);
-            info.SetMaxLevel(max_level);
-        }
-        if (ppr.countval("volume_weighting") > 0) {
-            int volume_weighting;
-            ppr.get("volume_weighting", volume_weighting);
-            info.SetVolumeWeighting(volume_weighting);
-        }
-        if (ppr.countval("derefine") > 0) {
-            int derefine;
-            ppr.get("derefine", derefine);
-            info.SetDerefine(derefine);
-        }
+        ppr.query("start_time", ind.min_time);
+        ppr.query("end_time", ind.max_time);
+        ppr.query("max_level", ind.max_level);
+
+        int volume_weighting = 0;
+        ppr.query("volume_weighting", volume_weighting);
+        ind.volume_weighting = volume_weighting;
+
+        int derefine = 0;
+        ppr.query("derefine", derefine);
+        ind.derefine = derefine;
+
+        std::string test_name;
 
         if (ppr.countval("value_greater")) {
-            Vector<Real> value;
-            ppr.getarr("value_greater", value, 0, ppr.countval("value_greater"));
-            std::string field;
-            ppr.get("field_name", field);
-            error_tags.emplace_back(value, AMRErrorTag::GREATER, field, info);
+            ind.test = tagging::GREATER;
+            test_name = "value_greater";
         }
         else if (ppr.countval("value_less")) {
-            Vector<Real> value;
-            ppr.getarr("value_less", value, 0, ppr.countval("value_less"));
-            std::string field;
-            ppr.get("field_name", field);
-            error_tags.emplace_back(value, AMRErrorTag::LESS, field, info);
+            ind.test = tagging::LESS;
+            test_name = "value_less";
         }
         else if (ppr.countval("gradient")) {
-            Vector<Real> value;
-            ppr.getarr("gradient", value, 0, ppr.countval("gradient"));
-            std::string field;
-            ppr.get("field_name", field);
-            error_tags.emplace_back(value, AMRErrorTag::GRAD, field, info);
+            ind.test = tagging::GRAD;
+            test_name = "gradient";
         }
         else if (ppr.countval("relative_gradient")) {
-            Vector<Real> value;
-            ppr.getarr("relative_gradient", value, 0, ppr.countval("relative_gradient"));
-            std::string field;
-            ppr.get("field_name", field);
-            error_tags.emplace_back(value, AMRErrorTag::RELGRAD, field, info);
+            ind.test = tagging::RELGRAD;
+            test_name = "relative_gradient";
         }
         else {
             amrex::Abort("Unrecognized refinement indicator for " + ref_indicator);
         }
+
+        ppr.getarr(test_name.c_str(), ind.value, 0, ppr.countval(test_name.c_str()));
+        ppr.get("field_name", ind.field);
+
+        tag_indicators.push_back(ind);
     }
 
 }
@@ -1034,6 +1088,12 @@ Castro::initData ()
     React_new.setVal(0.);
 #endif
 
+    // until we have measured something, every zone costs the same
+
+    if (Work_Estimate_Type >= 0) {
+        get_new_data(Work_Estimate_Type).setVal(1.0);
+    }
+
 #ifdef SIMPLIFIED_SDC
 #ifdef REACTIONS
    if (time_integration_method == SimplifiedSpectralDeferredCorrections) {
@@ -1454,14 +1514,12 @@ Castro::init (AmrLevel &old)
     setTimeLevel(cur_time,dt_old,dt_new);
 
     for (int s = 0; s < num_state_type; ++s) {
-        MultiFab& state_MF = get_new_data(s);
-        FillPatch(old, state_MF, state_MF.nGrow(), cur_time, s, 0, state_MF.nComp());
+        regrid_state_data(old, oldlev->get_new_data(s), get_new_data(s), cur_time, s);
         if (oldlev->state[s].hasOldData()) {
             if (!state[s].hasOldData()) {
                 state[s].allocOldData();
             }
-            MultiFab& old_state_MF = get_old_data(s);
-            FillPatch(old, old_state_MF, old_state_MF.nGrow(), prev_time, s, 0, old_state_MF.nComp());
+            regrid_state_data(old, oldlev->get_old_data(s), get_old_data(s), prev_time, s);
         }
     }
 
@@ -1482,6 +1540,124 @@ Castro::init (AmrLevel &old)
 
     in_retry = oldlev->in_retry;
 
+    work_estimate_measured = oldlev->work_estimate_measured;
+
+}
+
+void
+Castro::regrid_state_data (AmrLevel& old, MultiFab& old_mf, MultiFab& new_mf,
+                           Real time, int state_indx)
+{
+    BL_PROFILE("Castro::regrid_state_data()");
+
+    const int ng = new_mf.nGrow();
+    const int ncomp = new_mf.nComp();
+
+    if (!incremental_regrid) {
+        FillPatch(old, new_mf, ng, time, state_indx, 0, ncomp);
+        return;
+    }
+
+    // Regrid only rebuilds a level if its BoxArray or DistributionMapping
+    // changed, so at least one box is new or has moved.
+
+    // Find the boxes that are the same as an old box on the same rank.
+    // These keep the data of their valid zones.  Everything else -- the
+    // other boxes, and the ghost zones of the kept boxes, which were
+    // filled for the old grids -- is FillPatched in one go, which only
+    // interpolates where the old level does not cover it.  The ghost
+    // zones of a kept box are filled along with its valid box, since the
+    // physical boundary conditions need the interior next to them.
+
+    const BoxArray& old_ba = old_mf.boxArray();
+    const BoxArray& new_ba = new_mf.boxArray();
+    const DistributionMapping& old_dm = old_mf.DistributionMap();
+    const DistributionMapping& new_dm = new_mf.DistributionMap();
+
+    Vector<int> kept_from(new_ba.size(), -1);
+
+    // the new boxes to FillPatch (with their ghost zones), and for each
+    // whether it is a kept box, whose valid zones we already have
+    BoxList fill_boxes(new_ba.ixType());
+    Vector<int> fill_index;
+    Vector<int> fill_pmap;
+
+    for (int i = 0; i < new_ba.size(); ++i) {
+        const Box& bx = new_ba[i];
+
+        for (const auto& isect : old_ba.intersections(bx)) {
+            if (old_ba[isect.first] == bx && old_dm[isect.first] == new_dm[i]) {
+                kept_from[i] = isect.first;
+                break;
+            }
+        }
+
+        if (kept_from[i] < 0 || ng > 0) {
+            fill_boxes.push_back(bx);
+            fill_index.push_back(i);
+            fill_pmap.push_back(new_dm[i]);
+        }
+    }
+
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+    for (MFIter mfi(new_mf); mfi.isValid(); ++mfi) {
+        const int iold = kept_from[mfi.index()];
+        if (iold < 0) {
+            continue;
+        }
+
+        auto const src = old_mf.const_array(iold);
+        auto const dst = new_mf.array(mfi);
+
+        amrex::ParallelFor(mfi.validbox(), ncomp,
+        [=] AMREX_GPU_DEVICE (int i, int j, int k, int n) noexcept
+        {
+            dst(i,j,k,n) = src(i,j,k,n);
+        });
+    }
+
+    if (fill_index.empty()) {
+        return;
+    }
+
+    BoxArray fill_ba(fill_boxes);
+    DistributionMapping fill_dm(fill_pmap);
+
+    MultiFab fill(fill_ba, fill_dm, ncomp, ng);
+
+    FillPatch(old, fill, ng, time, state_indx, 0, ncomp);
+
+    // fill has the same owners as the corresponding new boxes, so this
+    // is a local copy.  A new box takes all of its grown box; a kept
+    // box only its ghost zones.
+
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+    for (MFIter mfi(fill); mfi.isValid(); ++mfi) {
+        const int inew = fill_index[mfi.index()];
+        const Box& bx = mfi.validbox();
+
+        auto const src = fill.const_array(mfi);
+        auto const dst = new_mf.array(inew);
+
+        BoxList copy_boxes(bx.ixType());
+        if (kept_from[inew] < 0) {
+            copy_boxes.push_back(amrex::grow(bx, ng));
+        } else {
+            copy_boxes = amrex::boxDiff(amrex::grow(bx, ng), bx);
+        }
+
+        for (const Box& cbx : copy_boxes) {
+            amrex::ParallelFor(cbx, ncomp,
+            [=] AMREX_GPU_DEVICE (int i, int j, int k, int n) noexcept
+            {
+                dst(i,j,k,n) = src(i,j,k,n);
+            });
+        }
+    }
 }
 
 //
@@ -1514,6 +1690,8 @@ Castro::init ()
         MultiFab& state_MF = get_new_data(s);
         FillCoarsePatch(state_MF, 0, time, s, 0, state_MF.nComp(), state_MF.nGrow());
     }
+
+    work_estimate_measured = getLevel(level-1).work_estimate_measured;
 }
 
 Real
@@ -1542,60 +1720,168 @@ Castro::estTimeStep (int is_new)
       return fixed_dt;
     }
 
-    Real estdt = max_dt;
+    ReductionQueue rq;
 
-    std::string limiter = "castro.max_dt";
+    auto est = queue_timestep_estimate(rq, is_new);
+
+    const Real estdt = finish_timestep_estimate(rq, est);
+
+    rq.complete();
+
+    return estdt;
+}
+
+Castro::TimestepEstimate
+Castro::queue_timestep_estimate (ReductionQueue& rq, int is_new)
+{
+    BL_PROFILE("Castro::queue_timestep_estimate()");
 
-    // Start the hydro with the max_dt value, but divide by CFL
-    // to account for the fact that we multiply by it at the end.
-    // This ensures that if max_dt is more restrictive than the hydro
-    // criterion, we will get exactly max_dt for a timestep.
+    TimestepEstimate est;
 
-    Real estdt_hydro = max_dt / cfl;
+    if (fixed_dt > 0.0) {
+        return est;
+    }
 
     if (do_hydro)
     {
 
 #ifdef RADIATION
         if (Radiation::rad_hydro_combined) {
-
-            Real lestdt_hydro = estdt_rad(is_new);
-            ParallelDescriptor::ReduceRealMin(lestdt_hydro);
-            estdt_hydro = amrex::min(estdt_hydro, lestdt_hydro) * cfl;
-            if (verbose) {
-                amrex::Print() << "...estimated hydro-limited timestep at level " << level << ": " << estdt_hydro << std::endl;
-            }
+            est.hydro_local.value = estdt_rad(is_new);
         }
         else
         {
 #endif
 
 #ifdef MHD
-          auto hydro_dt = estdt_mhd(is_new);
+            est.hydro_local = estdt_mhd(is_new);
 #else
-          auto hydro_dt = estdt_cfl(is_new);
+            est.hydro_local = estdt_cfl(is_new);
+#endif
+
+#ifdef RADIATION
+        }
+#endif
+
+        est.hydro = rq.add(est.hydro_local.value, ReductionQueue::Min);
+    }
+
+#ifdef DIFFUSION
+    // the implicit solve has no stability limit
+
+    if (diffuse_temp && diffusion_method != 1) {
+        est.diffusion_local = estdt_temp_diffusion(is_new);
+        est.diffusion = rq.add(est.diffusion_local.value, ReductionQueue::Min);
+    }
 #endif
 
-          amrex::ParallelAllReduce::Min(hydro_dt, MPI_COMM_WORLD);
-          estdt_hydro = amrex::min(estdt_hydro, hydro_dt.value) * cfl;
-          if (verbose) {
-              amrex::Print() << "...estimated hydro-limited timestep at level " << level << ": " << estdt_hydro << std::endl;
-              std::string idx_str = "(i";
+#ifdef REACTIONS
+    if (do_react && (castro::dtnuc_e < 1.e199_rt || castro::dtnuc_X < 1.e199_rt)) {
+        est.burn_local = estdt_burning(is_new);
+        est.burn = rq.add(est.burn_local.value, ReductionQueue::Min);
+    }
+#endif
+
+    return est;
+}
+
+Real
+Castro::finish_timestep_estimate (ReductionQueue& rq, const TimestepEstimate& est)
+{
+    BL_PROFILE("Castro::finish_timestep_estimate()");
+
+    if (fixed_dt > 0.0) {
+        return fixed_dt;
+    }
+
+    Real estdt = max_dt;
+
+    std::string limiter = "castro.max_dt";
+
+    // The global minima of the limiters
+
+    const Real hydro_dt = est.hydro >= 0 ? rq.get(est.hydro) : 0.0_rt;
+    const Real diffuse_dt = est.diffusion >= 0 ? rq.get(est.diffusion) : 0.0_rt;
+    const Real burn_dt = est.burn >= 0 ? rq.get(est.burn) : 0.0_rt;
+
+    // Where each limit is set.  This is only needed for the diagnostics,
+    // so we only pay for the second reduction when verbose: each rank
+    // contributes the zone (linearized over the domain) of its local
+    // estimate if that is the global minimum, and the smallest wins.
+
+    IntVect hydro_idx(AMREX_D_DECL(0, 0, 0));
+    IntVect diffuse_idx(AMREX_D_DECL(0, 0, 0));
+    IntVect burn_idx(AMREX_D_DECL(0, 0, 0));
+
+    if (verbose) {
+
+        const Box& domain = geom.Domain();
+        const auto dlo = amrex::lbound(domain);
+        const auto len = amrex::length(domain);
+
+        auto linearize = [&] (const ValLocPair<Real, IntVect>& p, Real global_val) -> Real
+        {
+            if (p.value != global_val) {
+                return std::numeric_limits<Real>::max();
+            }
+            const auto iv = p.index.dim3();
+            return static_cast<Real>(linear_zone_index(iv.x, iv.y, iv.z, dlo, len));
+        };
+
+        auto delinearize = [&] (Real l) -> IntVect
+        {
+            return zone_from_linear_index(static_cast<Long>(l), dlo, len);
+        };
+
+        ReductionQueue loc_rq;
+
+        const int hydro_loc = est.hydro >= 0 ?
+            loc_rq.add(linearize(est.hydro_local, hydro_dt), ReductionQueue::Min) : -1;
+        const int diffuse_loc = est.diffusion >= 0 ?
+            loc_rq.add(linearize(est.diffusion_local, diffuse_dt), ReductionQueue::Min) : -1;
+        const int burn_loc = est.burn >= 0 ?
+            loc_rq.add(linearize(est.burn_local, burn_dt), ReductionQueue::Min) : -1;
+
+        if (hydro_loc >= 0) {
+            hydro_idx = delinearize(loc_rq.get(hydro_loc));
+        }
+        if (diffuse_loc >= 0) {
+            diffuse_idx = delinearize(loc_rq.get(diffuse_loc));
+        }
+        if (burn_loc >= 0) {
+            burn_idx = delinearize(loc_rq.get(burn_loc));
+        }
+
+        loc_rq.complete();
+    }
+
+    std::string idx_str = "(i";
 #if AMREX_SPACEDIM >= 2
-              idx_str += ",j";
+    idx_str += ",j";
 #endif
 #if AMREX_SPACEDIM == 3
-              idx_str += ",k";
+    idx_str += ",k";
 #endif
-              idx_str += ")";
+    idx_str += ")";
 
-              amrex::Print() << "...hydro-limited CFL timestep constrained at " << idx_str << " = " << hydro_dt.index << std::endl;
-          }
+    if (est.hydro >= 0)
+    {
+        // Start the hydro with the max_dt value, but divide by CFL
+        // to account for the fact that we multiply by it at the end.
+        // This ensures that if max_dt is more restrictive than the hydro
+        // criterion, we will get exactly max_dt for a timestep.
+
+        Real estdt_hydro = amrex::min(max_dt / cfl, hydro_dt) * cfl;
 
+        if (verbose) {
+            amrex::Print() << "...estimated hydro-limited timestep at level " << level << ": " << estdt_hydro << std::endl;
 #ifdef RADIATION
-        }
+            if (!Radiation::rad_hydro_combined)
 #endif
-
+            {
+                amrex::Print() << "...hydro-limited CFL timestep constrained at " << idx_str << " = " << hydro_idx << std::endl;
+            }
+        }
 
         // Determine if this is more restrictive than the maximum timestep limiting
 
@@ -1611,63 +1897,44 @@ Castro::estTimeStep (int is_new)
     // Note that the diffusion uses the same CFL safety factor
     // as the main hydrodynamics timestep limiter.
 
-    Real estdt_diffusion = max_dt / cfl;
-
-    if (diffuse_temp)
+    if (est.diffusion >= 0)
     {
-        auto diffuse_dt = estdt_temp_diffusion(is_new);
-        ParallelAllReduce::Min(diffuse_dt, MPI_COMM_WORLD);
-        estdt_diffusion = amrex::min(estdt_diffusion, diffuse_dt.value) * cfl;
+        Real diffuse_dt_scaled = diffuse_dt;
 
-        if (verbose) {
-            amrex::Print() << "...estimated diffusion-limited timestep at level " << level << ": " << estdt_diffusion << std::endl;
-            std::string idx_str = "(i";
-#if AMREX_SPACEDIM >= 2
-            idx_str += ",j";
-#endif
-#if AMREX_SPACEDIM == 3
-            idx_str += ",k";
-#endif
-            idx_str += ")";
+        // RKL2 can take a step that is a multiple of the explicit limit,
+        // set by the number of stages we allow (this must agree with
+        // the substepping in do_split_temp_diffusion)
+
+        if (diffusion_method == 2) {
+            diffuse_dt_scaled = rkl2_max_dt(diffuse_dt, diffusion_rkl2_max_stages);
+        }
 
-            amrex::Print() << "...diffusion-limited timestep constrained at " << idx_str << " = " << diffuse_dt.index << std::endl;
+        Real estdt_diffusion = amrex::min(max_dt / cfl, diffuse_dt_scaled) * cfl;
 
+        if (verbose) {
+            amrex::Print() << "...estimated diffusion-limited timestep at level " << level << ": " << estdt_diffusion << std::endl;
+            amrex::Print() << "...diffusion-limited timestep constrained at " << idx_str << " = " << diffuse_idx << std::endl;
         }
-    }
 
-    // Determine if this is more restrictive than the hydro limiting
+        // Determine if this is more restrictive than the hydro limiting
 
-    if (estdt_diffusion < estdt) {
-        limiter = "diffusion";
-        estdt = estdt_diffusion;
+        if (estdt_diffusion < estdt) {
+            limiter = "diffusion";
+            estdt = estdt_diffusion;
+        }
     }
 #endif  // diffusion
 
 #ifdef REACTIONS
-    // Dummy value to start with
-    Real estdt_burn = max_dt;
-
-    if (do_react && (castro::dtnuc_e < 1.e199_rt || castro::dtnuc_X < 1.e199_rt)) {
+    if (est.burn >= 0) {
 
         // Compute burning-limited timestep.
 
-        auto burn_dt = estdt_burning(is_new);
-
-        ParallelAllReduce::Min(burn_dt, MPI_COMM_WORLD);
-        estdt_burn = amrex::min(estdt_burn, burn_dt.value);
+        Real estdt_burn = amrex::min(max_dt, burn_dt);
 
         if (verbose && estdt_burn < max_dt) {
             amrex::Print() << "...estimated burning-limited timestep at level " << level << ": " << estdt_burn << std::endl;
-            std::string idx_str = "(i";
-#if AMREX_SPACEDIM >= 2
-            idx_str += ",j";
-#endif
-#if AMREX_SPACEDIM == 3
-            idx_str += ",k";
-#endif
-            idx_str += ")";
-
-            amrex::Print() << "...burning-limited timestep constrained at " << idx_str << " = " << burn_dt.index << std::endl;
+            amrex::Print() << "...burning-limited timestep constrained at " << idx_str << " = " << burn_idx << std::endl;
         }
 
         // Determine if this is more restrictive than the hydro limiting
@@ -1712,12 +1979,25 @@ Castro::computeNewDt (int                    finest_level,
 
     Real dt_0 = 1.0e+100;
     int n_factor = 1;
+    // The estimates of all the levels share one reduction
+
+    ReductionQueue rq;
+    Vector<TimestepEstimate> est(finest_level + 1);
+
+    for (int i = 0; i <= finest_level; i++)
+    {
+        est[i] = getLevel(i).queue_timestep_estimate(rq);
+    }
+
+    rq.start();
+
     for (int i = 0; i <= finest_level; i++)
     {
-        Castro& adv_level = getLevel(i);
-        dt_min[i] = adv_level.estTimeStep();
+        dt_min[i] = getLevel(i).finish_timestep_estimate(rq, est[i]);
     }
 
+    rq.complete();
+
     if (fixed_dt <= 0.0)
     {
        if (post_regrid_flag == 1)
@@ -1948,6 +2228,10 @@ Castro::post_timestep (int iteration_local)
     //
     int finest_level = parent->finestLevel();
 
+    // Print the source change diagnostics queued during the advance
+
+    source_change_reductions.complete();
+
 #ifdef RADIATION
     if (do_radiation && (level < finest_level)) {
         // computeTemp is not needed before or after this call because
@@ -2004,6 +2288,15 @@ Castro::post_timestep (int iteration_local)
 
 #endif
 
+#ifdef GRAVITY
+    // Drop the cached HSE columns of boxes that were not filled during
+    // this coarse timestep.
+
+    if (hse_cache == 1 && level == 0) {
+        prune_hse_fill_cache();
+    }
+#endif
+
     if (level == 0)
     {
         int nstep = parent->levelSteps(0);
@@ -2063,26 +2356,37 @@ Castro::post_timestep (int iteration_local)
         {
             int ngrow = (level == 0) ? 0 : iteration_local;
 
-            TracerPC->Redistribute(level, parent->finestLevel(), ngrow);
+            TracerPC->Redistribute(level, parent->finestLevel(), ngrow,
+                                   particles::local_redistribute);
 
             TimestampParticles(ngrow+1);
         }
+
+        // the particles on all levels have just been redistributed
+        if (level == 0) {
+            RecordParticleHistory();
+        }
     }
 #endif
 
     // Check to see if the user-supplied stopping criterion has been met.
 
     if (!castro::stopping_criterion_field.empty() && level == 0) {
-        Real max_field_val = std::numeric_limits<Real>::min();
+        Real max_field_val = std::numeric_limits<Real>::lowest();
+
+        // take the local maximum over all the levels, and reduce once
 
         for (int lev = 0; lev <= parent->finestLevel(); ++lev) {
             auto mf = getLevel(lev).derive(castro::stopping_criterion_field, state[State_Type].curTime(), 0);
-            max_field_val = std::max(max_field_val, mf->max(0));
+            max_field_val = std::max(max_field_val, mf->max(0, 0, true));
         }
 
-        int to_stop = (max_field_val >= castro::stopping_criterion_value);
+        ReductionQueue rq;
+        const int max_h = rq.add(max_field_val, ReductionQueue::Max);
 
-        amrex::ParallelDescriptor::ReduceIntMax(to_stop);
+        const bool to_stop = rq.get(max_h) >= castro::stopping_criterion_value;
+
+        rq.complete();
 
         if (to_stop) {
 
@@ -2189,6 +2493,10 @@ Castro::post_restart ()
       }
 #endif
 
+    if (level == 0 && print_memory_footprint) {
+        print_state_memory_footprint();
+    }
+
 #ifdef DO_PROBLEM_POST_RESTART
     problem_post_restart();
 #endif
@@ -2219,7 +2527,18 @@ Castro::post_regrid (int lbase,
 
     BL_PROFILE("Castro::post_regrid()");
 
-    fine_mask.clear();
+    // With the incremental regrid, build_fine_mask notices on its own
+    // if the coarser grids changed, so we only rebuild it if needed.
+
+    if (!incremental_regrid) {
+        fine_mask.clear();
+    }
+
+#ifdef GRAVITY
+    if (hse_cache == 1 && level == lbase) {
+        clear_hse_fill_cache();
+    }
+#endif
 
 #ifdef AMREX_PARTICLES
     if (TracerPC && level == lbase) {
@@ -2396,6 +2715,10 @@ Castro::post_init (Real /*stop_time*/)
     }
 #endif
 
+    if (print_memory_footprint) {
+        print_state_memory_footprint();
+    }
+
 // Allow the user to define their own post_init functions.
 
 #ifdef DO_PROBLEM_POST_INIT
@@ -3150,6 +3473,29 @@ Castro::normalize_species (MultiFab& S_new, int ng)
     }
 }
 
+void
+Castro::normalize_species (const Box& bx, Array4<Real> const u)
+{
+    Real lsmall_x = network_rp::small_x;
+
+    amrex::ParallelFor(bx,
+    [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+    {
+        Real rhoX_sum = 0.0_rt;
+
+        for (int n = 0; n < NumSpec; ++n) {
+            u(i,j,k,UFS+n) = amrex::max(lsmall_x * u(i,j,k,URHO), amrex::min(u(i,j,k,URHO), u(i,j,k,UFS+n)));
+            rhoX_sum += u(i,j,k,UFS+n);
+        }
+
+        Real fac = u(i,j,k,URHO) / rhoX_sum;
+
+        for (int n = 0; n < NumSpec; ++n) {
+            u(i,j,k,UFS+n) *= fac;
+        }
+    });
+}
+
 void
 Castro::enforce_consistent_e (
 #ifdef MHD
@@ -3247,15 +3593,41 @@ Castro::enforce_min_density (MultiFab& state_in, int ng)
 }
 
 advance_status
-Castro::check_for_negative_density ()
+Castro::check_state_validity (bool after_clean)
 {
-    BL_PROFILE("check_for_negative_density()");
+    BL_PROFILE("Castro::check_state_validity()");
 
-    MultiFab& S_old = get_old_data(State_Type);
-    MultiFab& S_new = get_new_data(State_Type);
+    advance_status status {};
+
+    if (castro::state_check_interval <= 0 ||
+        parent->levelSteps(level) % castro::state_check_interval != 0) {
+        return status;
+    }
+
+    const MultiFab& S_old = get_old_data(State_Type);
+    const MultiFab& S_new = get_new_data(State_Type);
 
-    ReduceOps<ReduceOpMax, ReduceOpMax> reduce_op;
-    ReduceData<int, int> reduce_data(reduce_op);
+    // Optionally skip the zones covered by the next finer level
+
+    const bool skip_covered = castro::state_check_skip_covered && level < parent->finestLevel();
+    const MultiFab* mask = skip_covered ? &getLevel(level+1).build_fine_mask() : nullptr;
+
+    // For each check, the first (in a lexicographic ordering of
+    // the domain) zone that fails it
+
+    const auto dlo = amrex::lbound(geom.Domain());
+    const auto len = amrex::length(geom.Domain());
+
+    constexpr Long no_failure = std::numeric_limits<Long>::max();
+
+    const bool check_eint = castro::state_check_eint;
+    const bool check_species_sum = castro::state_check_species_sum;
+    const Real T_min = castro::state_check_T_min;
+    const Real T_max = castro::state_check_T_max;
+
+    ReduceOps<ReduceOpMin, ReduceOpMin, ReduceOpMin,
+              ReduceOpMin, ReduceOpMin, ReduceOpMin> reduce_op;
+    ReduceData<Long, Long, Long, Long, Long, Long> reduce_data(reduce_op);
     using ReduceTuple = typename decltype(reduce_data)::Type;
 
 #ifdef AMREX_USE_OMP
@@ -3264,34 +3636,83 @@ Castro::check_for_negative_density ()
     for (MFIter mfi(S_new, TilingIfNotGPU()); mfi.isValid(); ++mfi) {
         const Box& bx = mfi.tilebox();
 
-        auto S_old_arr = S_old.array(mfi);
-        auto S_new_arr = S_new.array(mfi);
+        auto S_old_arr = S_old.const_array(mfi);
+        auto S_new_arr = S_new.const_array(mfi);
+
+        auto mask_arr = skip_covered ? mask->const_array(mfi) : Array4<Real const>{};
 
         reduce_op.eval(bx, reduce_data,
         [=] AMREX_GPU_DEVICE (int i, int j, int k) -> ReduceTuple
         {
-            int rho_check_failed = 0;
-            int X_check_failed = 0;
+            Long nan_failed = no_failure;
+            Long rho_failed = no_failure;
+            Long X_failed = no_failure;
+            Long X_sum_failed = no_failure;
+            Long eint_failed = no_failure;
+            Long T_failed = no_failure;
+
+            if (skip_covered && mask_arr(i,j,k) == 0.0_rt) {
+                return {nan_failed, rho_failed, X_failed, X_sum_failed, eint_failed, T_failed};
+            }
 
-            Real rho = S_new_arr(i,j,k,URHO);
-            Real rhoInv = 1.0_rt / rho;
+            const Long idx = linear_zone_index(i, j, k, dlo, len);
 
-            // Optionally, the user can ignore this if the starting
-            // density is lower than a certain threshold. This is useful
-            // if the minimum density occurs in material that is not
-            // dynamically important; in that case, a density reset suffices.
+            // The temperature is only meaningful once computeTemp has
+            // been called in clean_state, and the other quantities are
+            // reset there.  A NaN or Inf survives clean_state (and can
+            // be produced by it), so we only scan the full state for
+            // them here.
 
-            if (S_old_arr(i,j,k,URHO) >= retry_small_density_cutoff && rho < small_dens) {
+            if (after_clean) {
+                for (int n = 0; n < NUM_STATE; ++n) {
+                    if (amrex::isnan(S_new_arr(i,j,k,n)) || amrex::isinf(S_new_arr(i,j,k,n))) {
 #ifndef AMREX_USE_GPU
-                std::cout << "Invalid density = " << rho << " at index " << i << ", " << j << ", " << k << "\n";
+                        std::cout << "Invalid state component " << n << " = " << S_new_arr(i,j,k,n)
+                                  << " at index " << i << ", " << j << ", " << k << "\n";
 #endif
-                rho_check_failed = 1;
+                        nan_failed = idx;
+                    }
+                }
+
+                // any NaN or Inf makes the temperature check meaningless
+
+                if (nan_failed != no_failure) {
+                    return {nan_failed, rho_failed, X_failed, X_sum_failed, eint_failed, T_failed};
+                }
+
+                if (S_new_arr(i,j,k,UTEMP) < T_min || S_new_arr(i,j,k,UTEMP) > T_max) {
+#ifndef AMREX_USE_GPU
+                    std::cout << "Invalid temperature = " << S_new_arr(i,j,k,UTEMP) << " at index "
+                              << i << ", " << j << ", " << k << "\n";
+#endif
+                    T_failed = idx;
+                }
+
+                return {nan_failed, rho_failed, X_failed, X_sum_failed, eint_failed, T_failed};
             }
 
-            if (S_new_arr(i,j,k,URHO) >= castro::abundance_failure_rho_cutoff) {
+            Real rho = S_new_arr(i,j,k,URHO);
+            Real rhoInv = 1.0_rt / rho;
+
+            // Optionally, the user can ignore this if the starting
+            // density is lower than a certain threshold. This is useful
+            // if the minimum density occurs in material that is not
+            // dynamically important; in that case, a density reset suffices.
+
+            if (S_old_arr(i,j,k,URHO) >= retry_small_density_cutoff && rho < small_dens) {
+#ifndef AMREX_USE_GPU
+                std::cout << "Invalid density = " << rho << " at index " << i << ", " << j << ", " << k << "\n";
+#endif
+                rho_failed = idx;
+            }
+
+            if (rho >= castro::abundance_failure_rho_cutoff) {
+
+                Real X_sum = 0.0_rt;
 
                 for (int n = 0; n < NumSpec; ++n) {
                     Real X = S_new_arr(i,j,k,UFS+n) * rhoInv;
+                    X_sum += X;
 
                     if (X < -castro::abundance_failure_tolerance ||
                         X > 1.0_rt + castro::abundance_failure_tolerance) {
@@ -3300,36 +3721,76 @@ Castro::check_for_negative_density ()
                                   << i << ", " << j << ", " << k
                                   << " with density = " << rho << "\n";
 #endif
-                        X_check_failed = 1;
+                        X_failed = idx;
                     }
                 }
 
+                if (check_species_sum && std::abs(X_sum - 1.0_rt) > castro::abundance_failure_tolerance) {
+#ifndef AMREX_USE_GPU
+                    std::cout << "Invalid sum of X = " << X_sum << " in zone "
+                              << i << ", " << j << ", " << k
+                              << " with density = " << rho << "\n";
+#endif
+                    X_sum_failed = idx;
+                }
+
             }
 
-            return {rho_check_failed, X_check_failed};
+            if (check_eint && S_new_arr(i,j,k,UEINT) < 0.0_rt) {
+#ifndef AMREX_USE_GPU
+                std::cout << "Invalid (rho e) = " << S_new_arr(i,j,k,UEINT) << " at index "
+                          << i << ", " << j << ", " << k << "\n";
+#endif
+                eint_failed = idx;
+            }
+
+            return {nan_failed, rho_failed, X_failed, X_sum_failed, eint_failed, T_failed};
         });
 
     }
 
     ReduceTuple hv = reduce_data.value();
-    int rho_check_failed = amrex::get<0>(hv);
-    int X_check_failed = amrex::get<1>(hv);
 
-    ParallelDescriptor::ReduceIntMax(rho_check_failed);
-    ParallelDescriptor::ReduceIntMax(X_check_failed);
+    const Long local_failed[6] = {amrex::get<0>(hv), amrex::get<1>(hv), amrex::get<2>(hv),
+                                  amrex::get<3>(hv), amrex::get<4>(hv), amrex::get<5>(hv)};
 
-    advance_status status {};
+    // in the order of precedence for the reason we give
+
+    const std::string check_name[6] = {"NaN or Inf in the state", "invalid density", "invalid X",
+                                       "invalid sum of X", "negative internal energy",
+                                       "invalid temperature"};
 
-    if (rho_check_failed == 1) {
-        status.success = false;
-        status.reason = "invalid density";
+    // All the checks go in one reduction.  The zone indices are
+    // represented exactly in a Real for any reasonable domain.
+
+    ReductionQueue rq;
+
+    Real first_failed[6];
+    for (int n = 0; n < 6; ++n) {
+        first_failed[n] = local_failed[n] == no_failure ? std::numeric_limits<Real>::max()
+                                                        : static_cast<Real>(local_failed[n]);
     }
 
-    if (X_check_failed == 1) {
-        status.success = false;
-        status.reason = "invalid X";
+    const int handle = rq.add(first_failed, 6, ReductionQueue::Min);
+
+    for (int n = 0; n < 6; ++n) {
+        const Real first = rq.get(handle + n);
+
+        if (first < std::numeric_limits<Real>::max()) {
+            const IntVect iv = zone_from_linear_index(static_cast<Long>(first), dlo, len);
+
+            std::ostringstream reason;
+            reason << check_name[n] << " in zone " << iv;
+
+            status.success = false;
+            status.reason = reason.str();
+
+            break;
+        }
     }
 
+    rq.complete();
+
     return status;
 }
 
@@ -3351,33 +3812,41 @@ Castro::enforce_speed_limit (MultiFab& state_in, int ng)
     for (MFIter mfi(state_in, TilingIfNotGPU()); mfi.isValid(); ++mfi) {
         const Box& bx = mfi.growntilebox(ng);
 
-        auto u = state_in[mfi].array();
+        enforce_speed_limit(bx, state_in.array(mfi));
+    }
+}
 
-        amrex::ParallelFor(bx,
-        [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
-        {
-            Real rho = u(i,j,k,URHO);
-            Real rhoInv = 1.0_rt / rho;
+void
+Castro::enforce_speed_limit (const Box& bx, Array4<Real> const u)
+{
+    if (castro::speed_limit <= 0.0_rt) {
+        return;
+    }
 
-            Real vx = u(i,j,k,UMX) * rhoInv;
-            Real vy = u(i,j,k,UMY) * rhoInv;
-            Real vz = u(i,j,k,UMZ) * rhoInv;
+    amrex::ParallelFor(bx,
+    [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+    {
+        Real rho = u(i,j,k,URHO);
+        Real rhoInv = 1.0_rt / rho;
 
-            Real v = std::sqrt(vx * vx + vy * vy + vz * vz);
+        Real vx = u(i,j,k,UMX) * rhoInv;
+        Real vy = u(i,j,k,UMY) * rhoInv;
+        Real vz = u(i,j,k,UMZ) * rhoInv;
 
-            if (v > castro::speed_limit) {
-                Real reduce_factor = castro::speed_limit / v;
+        Real v = std::sqrt(vx * vx + vy * vy + vz * vz);
 
-                u(i,j,k,UMX) *= reduce_factor;
-                u(i,j,k,UMY) *= reduce_factor;
-                u(i,j,k,UMZ) *= reduce_factor;
+        if (v > castro::speed_limit) {
+            Real reduce_factor = castro::speed_limit / v;
 
-                u(i,j,k,UEDEN) -= 0.5_rt * rhoInv * (rho * vx * rho * vx - u(i,j,k,UMX) * u(i,j,k,UMX) +
-                                                     rho * vy * rho * vy - u(i,j,k,UMY) * u(i,j,k,UMY) +
-                                                     rho * vz * rho * vz - u(i,j,k,UMZ) * u(i,j,k,UMZ));
-            }
-        });
-    }
+            u(i,j,k,UMX) *= reduce_factor;
+            u(i,j,k,UMY) *= reduce_factor;
+            u(i,j,k,UMZ) *= reduce_factor;
+
+            u(i,j,k,UEDEN) -= 0.5_rt * rhoInv * (rho * vx * rho * vx - u(i,j,k,UMX) * u(i,j,k,UMX) +
+                                                 rho * vy * rho * vy - u(i,j,k,UMY) * u(i,j,k,UMY) +
+                                                 rho * vz * rho * vz - u(i,j,k,UMZ) * u(i,j,k,UMZ));
+        }
+    });
 }
 
 void
@@ -3430,80 +3899,106 @@ Castro::errorEst (TagBoxArray& tags,
 {
     BL_PROFILE("Castro::errorEst()");
 
-    Real ltime = time;
+    // Gather the refinement indicators that apply now and the fields
+    // they test.  Each field is derived only once, into its own
+    // component, however many indicators use it.
+
+    Vector<tagging::Criterion> criteria;
+    Vector<std::string> fields;
+    int ng = 0;
+
+    for (const auto& ind : tag_indicators) {
+        if (!ind.active(time, level)) {
+            continue;
+        }
+
+        auto it = std::find(fields.begin(), fields.end(), ind.field);
+        const int comp = static_cast<int>(it - fields.begin());
+        if (it == fields.end()) {
+            fields.push_back(ind.field);
+        }
 
-    // If we are forcing a post-timestep regrid,
-    // note that we need to use the new time here,
-    // not the old time.
+        ng = amrex::max(ng, ind.ngrow());
 
-    if (post_step_regrid) {
-      ltime = get_state_data(State_Type).curTime();
+        criteria.push_back({ind.test, comp, ind.threshold(level),
+                            static_cast<int>(ind.volume_weighting),
+                            static_cast<char>(ind.derefine ? TagBox::CLEAR : TagBox::SET)});
     }
 
-    // Apply each of the tagging criteria defined in the inputs.
+    MultiFab tag_fields;
 
-    for (const auto & etag : error_tags) {
-        std::unique_ptr<MultiFab> mf;
-        if (! etag.Field().empty()) {
-            mf = derive(etag.Field(), time, etag.NGrow());
+    if (!fields.empty()) {
+        tag_fields.define(grids, dmap, static_cast<int>(fields.size()), ng);
+
+        for (int n = 0; n < static_cast<int>(fields.size()); ++n) {
+            derive(fields[n], time, tag_fields, n);
         }
-        etag(tags, mf.get(), TagBox::CLEAR, TagBox::SET, time, level, geom);
     }
 
-    // Now we'll tag any user-specified zones using the full state array.
-
-    apply_problem_tags(tags, ltime);
+    const int ncrit = static_cast<int>(criteria.size());
 
-    // Finally we'll apply any tagging restrictions which must be obeyed by any setup.
+    Gpu::DeviceVector<tagging::Criterion> criteria_d(ncrit);
+    Gpu::copy(Gpu::hostToDevice, criteria.begin(), criteria.end(), criteria_d.begin());
+    const tagging::Criterion* const crit = criteria_d.dataPtr();
 
-    apply_tagging_restrictions(tags, ltime);
+    // The restrictions that any setup must obey: Poisson gravity
+    // boundaries, and the largest distance from the center we tag.
 
-}
+    const tagging::BoundaryBuffer bb = tagging_boundary_buffer();
 
+    const auto geomdata = geom.data();
 
+    Real max_dist_lo = 0.0;
+    Real max_dist_hi = 0.0;
 
-void
-Castro::apply_problem_tags (TagBoxArray& tags, Real time)
-{
+    for (int dim = 0; dim < AMREX_SPACEDIM; ++dim) {
+        max_dist_lo = amrex::max(max_dist_lo, std::abs(geom.ProbLo(dim) - problem::center[dim]));
+        max_dist_hi = amrex::max(max_dist_hi, std::abs(geom.ProbHi(dim) - problem::center[dim]));
+    }
 
-    amrex::ignore_unused(time);
+    const Real max_r = castro::max_tagging_radius * amrex::max(max_dist_lo, max_dist_hi);
 
-    BL_PROFILE("Castro::apply_problem_tags()");
+    // Now one pass over the zones applies, in order, the indicators
+    // from the inputs, the user-specified tagging (problem_tagging
+    // should only set the tag of the zone it is given), and the
+    // restrictions.
 
     MultiFab& S_new = get_new_data(State_Type);
 
-    int lev = level;
+    const int lev = level;
 
 #ifdef AMREX_USE_OMP
 #pragma omp parallel
 #endif
+    for (MFIter mfi(tags, TilingIfNotGPU()); mfi.isValid(); ++mfi)
     {
-        for (MFIter mfi(tags, TilingIfNotGPU()); mfi.isValid(); ++mfi)
-        {
-            const Box& bx = mfi.tilebox();
+        const Box& bx = mfi.tilebox();
 
-            TagBox& tagfab = tags[mfi];
+        auto tag = tags[mfi].array();
+        auto state_arr = S_new.const_array(mfi);
+        auto dat = ncrit > 0 ? tag_fields.const_array(mfi) : Array4<Real const>{};
+
+        amrex::ParallelFor(bx,
+        [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+        {
+            for (int n = 0; n < ncrit; ++n) {
+                tagging::apply(i, j, k, crit[n], dat, tag, geomdata);
+            }
 
-            auto tag_arr = tagfab.array();
-            const auto state_arr = S_new[mfi].array();
-            const GeometryData& geomdata = geom.data();
+            problem_tagging(i, j, k, tag, state_arr, lev, geomdata);
 
-            amrex::ParallelFor(bx,
-            [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
-            {
-                problem_tagging(i, j, k, tag_arr, state_arr, lev, geomdata);
-            });
-        }
+            tagging::restrict_tag(i, j, k, tag, bb, max_r, geomdata);
+        });
     }
 
 }
 
 
 
-void
-Castro::apply_tagging_restrictions(TagBoxArray& tags, [[maybe_unused]] Real time)
+tagging::BoundaryBuffer
+Castro::tagging_boundary_buffer () const
 {
-    BL_PROFILE("Castro::apply_tagging_restrictions()");
+    tagging::BoundaryBuffer bb;
 
     // If we are using Poisson gravity, we must ensure that the outermost zones are untagged
     // due to the Poisson equation boundary conditions (we currently do not know how to fill
@@ -3520,140 +4015,159 @@ Castro::apply_tagging_restrictions(TagBoxArray& tags, [[maybe_unused]] Real time
 #ifdef GRAVITY
     if (gravity::gravity_type == "PoissonGrav") {
 
-        int lev = level;
+        bb.active = 1;
 
-        int n_error_buf[3] = {0};
-        int ref_ratio[3] = {0};
-        int domlo[3] = {0};
-        int domhi[3] = {0};
-        int physbc_lo[3] = {-1};
-        int physbc_hi[3] = {-1};
-        int blocking_factor[3] = {0};
         for (int dim = 0; dim < AMREX_SPACEDIM; ++dim) {
-            n_error_buf[dim] = parent->nErrorBuf(lev, dim);
-            ref_ratio[dim] = parent->refRatio(lev)[dim];
-            domlo[dim] = geom.Domain().loVect()[dim];
-            domhi[dim] = geom.Domain().hiVect()[dim];
-            physbc_lo[dim] = phys_bc.lo()[dim];
-            physbc_hi[dim] = phys_bc.hi()[dim];
-            blocking_factor[dim] = parent->blockingFactor(lev)[dim];
+            bb.buf[dim] = parent->nErrorBuf(level, dim) +
+                          parent->blockingFactor(level)[dim] / parent->refRatio(level)[dim];
+            bb.domlo[dim] = geom.Domain().loVect()[dim];
+            bb.domhi[dim] = geom.Domain().hiVect()[dim];
+            bb.physbc_lo[dim] = phys_bc.lo()[dim];
+            bb.physbc_hi[dim] = phys_bc.hi()[dim];
         }
-
-#ifdef AMREX_USE_OMP
-#pragma omp parallel
+    }
 #endif
-        for (MFIter mfi(tags, TilingIfNotGPU()); mfi.isValid(); ++mfi) {
-            const Box& bx = mfi.tilebox();
 
-            auto tag = tags[mfi].array();
+    return bb;
+}
 
-            amrex::ParallelFor(bx,
-            [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
-            {
-                bool outer_boundary_test[3] = {false};
 
-                int idx[3] = {i, j, k};
 
-                for (int dim = 0; dim < AMREX_SPACEDIM; ++dim) {
+std::unique_ptr<MultiFab>
+Castro::derive (const std::string& name,
+                Real           time,
+                int            ngrow)
+{
 
-                    int boundary_buf = n_error_buf[dim] + blocking_factor[dim] / ref_ratio[dim];
+    BL_PROFILE("Castro::derive()");
 
-                    if ((physbc_lo[dim] != Symmetry && physbc_lo[dim] != Interior) &&
-                        (idx[dim] <= domlo[dim] + boundary_buf)) {
-                        outer_boundary_test[dim] = true;
-                    }
+    if (ngrow == 0 && use_thermo_cache) {
+        auto mf = std::make_unique<MultiFab>(grids, dmap, 1, 0);
+        if (derive_from_thermo_cache(name, time, *mf, 0)) {
+            return mf;
+        }
+    }
 
-                    if ((physbc_hi[dim] != Symmetry && physbc_lo[dim] != Interior) &&
-                        (idx[dim] >= domhi[dim] - boundary_buf)) {
-                        outer_boundary_test[dim] = true;
-                    }
-                }
+#ifdef AMREX_PARTICLES
+  return ParticleDerive(name,time,ngrow);
+#else
+   return AmrLevel::derive(name,time,ngrow);
+#endif
+}
 
-                if (outer_boundary_test[0] || outer_boundary_test[1] || outer_boundary_test[2]) {
+void
+Castro::derive (const std::string& name,
+                Real           time,
+                MultiFab&      mf,
+                int            dcomp)
+{
 
-                    tag(i,j,k) = TagBox::CLEAR;
+    BL_PROFILE("Castro::derive()");
 
-                }
-            });
+    if (derive_from_thermo_cache(name, time, mf, dcomp)) {
+        return;
+    }
+
+#ifdef AMREX_PARTICLES
+    // The particle quantities are registered with a null derive
+    // function; they come from ParticleDerive.  That only gives the
+    // valid zones, so the ghost zones get what FillBoundary can give
+    // them (and zero outside the domain).
+
+    if (TracerPC && (name == "particle_count" || name == "total_particle_count")) {
+        auto derive_dat = ParticleDerive(name, time, 0);
+
+        mf.setVal(0.0, dcomp, 1, mf.nGrow());
+        MultiFab::Copy(mf, *derive_dat, 0, dcomp, 1, 0);
+
+        if (mf.nGrow() > 0) {
+            mf.FillBoundary(dcomp, 1, geom.periodicity());
         }
 
+        return;
     }
 #endif
 
-    auto geomdata = geom.data();
+    AmrLevel::derive(name,time,mf,dcomp);
+}
+
+bool
+Castro::thermo_cache_matches (const MultiFab& mf) const
+{
+    return use_thermo_cache && !thermo_cache.empty() &&
+           mf.boxArray() == thermo_cache.boxArray() &&
+           mf.DistributionMap() == thermo_cache.DistributionMap();
+}
+
+bool
+Castro::derive_from_thermo_cache (const std::string& name, Real time, MultiFab& mf, int dcomp)
+{
+    int comp = -1;
+
+    if (name == "pressure") {
+        comp = thermo_cache::p;
+    } else if (name == "soundspeed") {
+        comp = thermo_cache::cs;
+    } else if (name == "Gamma_1") {
+        comp = thermo_cache::gamc;
+    }
+
+    // we can only serve the valid zones of the new-time state
+
+    const StateData& sd = get_state_data(State_Type);
+
+    if (comp < 0 || mf.nGrow() > 0 || time != sd.curTime() || !thermo_cache_matches(mf)) {
+        return false;
+    }
+
+    BL_PROFILE("Castro::derive_from_thermo_cache()");
+
+    const MultiFab& S_new = sd.newData();
+    const Real rtol = thermo_cache_rtol;
 
-    // Allow the user to limit tagging outside of some distance from the problem center.
 #ifdef AMREX_USE_OMP
-#pragma omp parallel
+#pragma omp parallel if (Gpu::notInLaunchRegion())
 #endif
-    for (MFIter mfi(tags, TilingIfNotGPU()); mfi.isValid(); ++mfi) {
+    for (MFIter mfi(mf, TilingIfNotGPU()); mfi.isValid(); ++mfi) {
         const Box& bx = mfi.tilebox();
 
-        auto tag = tags[mfi].array();
+        auto u = S_new.const_array(mfi);
+        auto tc = thermo_cache.const_array(mfi);
+        auto der = mf.array(mfi);
 
         amrex::ParallelFor(bx,
         [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
         {
-            const Real* problo = geomdata.ProbLo();
-            const Real* probhi = geomdata.ProbHi();
-            const Real* dx = geomdata.CellSize();
-
-            Real loc[3] = {0.0};
+            Real rhoInv = 1.0_rt / u(i,j,k,URHO);
 
-            loc[0] = problo[0] + (static_cast<Real>(i) + 0.5_rt) * dx[0];
-#if AMREX_SPACEDIM >= 2
-            loc[1] = problo[1] + (static_cast<Real>(j) + 0.5_rt) * dx[1];
-#endif
-#if AMREX_SPACEDIM == 3
-            loc[2] = problo[2] + (static_cast<Real>(k) + 0.5_rt) * dx[2];
+            eos_rep_t eos_state;
+            eos_state.rho = u(i,j,k,URHO);
+            eos_state.T = u(i,j,k,UTEMP);
+            eos_state.e = u(i,j,k,UEINT) * rhoInv;
+            for (int n = 0; n < NumSpec; n++) {
+              eos_state.xn[n] = u(i,j,k,UFS+n) * rhoInv;
+            }
+#if NAUX_NET > 0
+            for (int n = 0; n < NumAux; n++) {
+              eos_state.aux[n] = u(i,j,k,UFX+n) * rhoInv;
+            }
 #endif
 
-            Real r = std::sqrt((loc[0] - problem::center[0]) * (loc[0] - problem::center[0]) +
-                               (loc[1] - problem::center[1]) * (loc[1] - problem::center[1]) +
-                               (loc[2] - problem::center[2]) * (loc[2] - problem::center[2]));
-
-            Real max_dist_lo = 0.0;
-            Real max_dist_hi = 0.0;
-
-            for (int dim = 0; dim < AMREX_SPACEDIM; ++dim) {
-                max_dist_lo = amrex::max(max_dist_lo, std::abs(problo[dim] - problem::center[dim]));
-                max_dist_hi = amrex::max(max_dist_hi, std::abs(probhi[dim] - problem::center[dim]));
+            if (!thermo_cache::load(tc, i, j, k, eos_state, rtol)) {
+                eos(eos_input_re, eos_state);
             }
 
-            if (r > castro::max_tagging_radius * amrex::max(max_dist_lo, max_dist_hi)) {
-                tag(i,j,k) = TagBox::CLEAR;
+            if (comp == thermo_cache::p) {
+                der(i,j,k,dcomp) = eos_state.p;
+            } else if (comp == thermo_cache::cs) {
+                der(i,j,k,dcomp) = eos_state.cs;
+            } else {
+                der(i,j,k,dcomp) = eos_state.gam1;
             }
         });
     }
-}
-
-
-
-std::unique_ptr<MultiFab>
-Castro::derive (const std::string& name,
-                Real           time,
-                int            ngrow)
-{
-
-    BL_PROFILE("Castro::derive()");
 
-#ifdef AMREX_PARTICLES
-  return ParticleDerive(name,time,ngrow);
-#else
-   return AmrLevel::derive(name,time,ngrow);
-#endif
-}
-
-void
-Castro::derive (const std::string& name,
-                Real           time,
-                MultiFab&      mf,
-                int            dcomp)
-{
-
-    BL_PROFILE("Castro::derive()");
-
-    AmrLevel::derive(name,time,mf,dcomp);
+    return true;
 }
 
 void
@@ -3979,6 +4493,29 @@ Castro::computeTemp(
   }
 #endif
 
+  // Optionally keep the full EOS results for reuse.  For 4th order
+  // the EOS works on the cell centers, which nothing else looks up.
+
+  bool fill_thermo_cache = false;
+
+  if (use_thermo_cache) {
+      if (thermo_cache.empty() || thermo_cache.boxArray() != grids ||
+          thermo_cache.DistributionMap() != dmap) {
+          thermo_cache.define(grids, dmap, thermo_cache::ncomp, NUM_GROW);
+
+          // a density of zero never matches a zone
+          thermo_cache.setVal(0.0_rt);
+      }
+
+      fill_thermo_cache = thermo_cache_matches(State);
+
+#ifdef TRUE_SDC
+      if (sdc_order == 4) {
+          fill_thermo_cache = false;
+      }
+#endif
+  }
+
 #ifdef AMREX_USE_OMP
 #pragma omp parallel
 #endif
@@ -4002,6 +4539,42 @@ Castro::computeTemp(
 
       Array4<Real> const u = u_fab.array();
 
+      if (fill_thermo_cache) {
+
+          Array4<Real> const tc = thermo_cache.array(mfi);
+
+          amrex::ParallelFor(bx,
+          [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+          {
+              Real rhoInv = 1.0_rt / u(i,j,k,URHO);
+
+              eos_rep_t eos_state;
+
+              eos_state.rho = u(i,j,k,URHO);
+              eos_state.T   = u(i,j,k,UTEMP); // Initial guess for the EOS
+              eos_state.e   = u(i,j,k,UEINT) * rhoInv;
+              for (int n = 0; n < NumSpec; ++n) {
+                eos_state.xn[n] = u(i,j,k,UFS+n) * rhoInv;
+              }
+#if NAUX_NET > 0
+              for (int n = 0; n < NumAux; ++n) {
+                eos_state.aux[n] = u(i,j,k,UFX+n) * rhoInv;
+              }
+#endif
+
+              const Real e_input = eos_state.e;
+
+              eos(eos_input_re, eos_state);
+
+              u(i,j,k,UTEMP) = eos_state.T;
+
+              if (tc.contains(i,j,k)) {
+                  thermo_cache::store(tc, i, j, k, e_input, eos_state);
+              }
+          });
+
+      } else {
+
       amrex::ParallelFor(bx,
       [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
       {
@@ -4028,6 +4601,8 @@ Castro::computeTemp(
 
       });
 
+      }
+
       if (clamp_ambient_temp == 1) {
           amrex::ParallelFor(bx,
           [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
@@ -4095,6 +4670,49 @@ Castro::computeTemp(
 
 }
 
+#ifndef MHD
+void
+Castro::computeTemp(const Box& bx, Array4<Real> const u)
+{
+    reset_internal_energy(bx, u);
+
+    const int lclamp_ambient_temp = clamp_ambient_temp;
+
+    amrex::ParallelFor(bx,
+    [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+    {
+        Real rhoInv = 1.0_rt / u(i,j,k,URHO);
+
+        eos_re_t eos_state;
+
+        eos_state.rho = u(i,j,k,URHO);
+        eos_state.T   = u(i,j,k,UTEMP); // Initial guess for the EOS
+        eos_state.e   = u(i,j,k,UEINT) * rhoInv;
+        for (int n = 0; n < NumSpec; ++n) {
+            eos_state.xn[n] = u(i,j,k,UFS+n) * rhoInv;
+        }
+#if NAUX_NET > 0
+        for (int n = 0; n < NumAux; ++n) {
+            eos_state.aux[n] = u(i,j,k,UFX+n) * rhoInv;
+        }
+#endif
+
+        eos(eos_input_re, eos_state);
+
+        u(i,j,k,UTEMP) = eos_state.T;
+
+        if (lclamp_ambient_temp == 1 &&
+            u(i,j,k,URHO) <= castro::ambient_safety_factor * ambient::ambient_state[URHO]) {
+            u(i,j,k,UTEMP) = ambient::ambient_state[UTEMP];
+            u(i,j,k,UEINT) = ambient::ambient_state[UEINT] * (u(i,j,k,URHO) * rhoInv);
+            u(i,j,k,UEDEN) = u(i,j,k,UEINT) + 0.5_rt * rhoInv * (u(i,j,k,UMX) * u(i,j,k,UMX) +
+                                                                 u(i,j,k,UMY) * u(i,j,k,UMY) +
+                                                                 u(i,j,k,UMZ) * u(i,j,k,UMZ));
+        }
+    });
+}
+#endif
+
 
 
 void
@@ -4203,6 +4821,12 @@ Castro::swap_state_time_levels(const Real dt)
         }
 #endif
 #endif
+
+        // the work estimate is a running average we keep updating
+
+        if (k == Work_Estimate_Type) {
+            state[k].swapTimeLevels(0.0);
+        }
         state[k].allocOldData();
 
         state[k].swapTimeLevels(dt);
@@ -4379,7 +5003,9 @@ Castro::build_fine_mask()
 
     BL_ASSERT(level > 0); // because we are building a mask for the coarser level
 
-    if (fine_mask.empty()) {
+    if (fine_mask.empty() ||
+        fine_mask.boxArray() != parent->boxArray(level-1) ||
+        fine_mask.DistributionMap() != parent->DistributionMap(level-1)) {
         fine_mask = makeFineMask(parent->boxArray(level-1),
                                  parent->DistributionMap(level-1),
                                  parent->boxArray(level), crse_ratio,
@@ -4428,6 +5054,100 @@ Castro::expand_state(MultiFab& S, Real time, int ng)
   AmrLevel::FillPatch(*this, S, ng, time, State_Type, 0, NUM_STATE);
 }
 
+bool
+Castro::can_overlap_sborder_fill() const
+{
+#if defined(MHD) || defined(RADIATION)
+    return false;
+#else
+    // On the coarse level the FillPatch is just a same-level ghost
+    // cell exchange followed by the physical boundary fill, so we can
+    // split it into a non-blocking start and a later finish.
+
+    return overlap_sborder_fill == 1 && level == 0;
+#endif
+}
+
+void
+Castro::start_sborder_fill(Real time)
+{
+    BL_PROFILE("Castro::start_sborder_fill()");
+
+    AMREX_ASSERT(can_overlap_sborder_fill());
+    AMREX_ASSERT(!sborder_fill_pending);
+
+    // The valid data is just a copy of the old state, which was
+    // already cleaned in initialize_advance.
+
+    MultiFab& S_old = get_old_data(State_Type);
+
+    MultiFab::Copy(Sborder, S_old, 0, 0, NUM_STATE, 0);
+
+    Sborder.FillBoundary_nowait(0, NUM_STATE, Sborder.nGrowVect(), geom.periodicity());
+
+    sborder_fill_pending = true;
+    sborder_fill_time = time;
+}
+
+void
+Castro::finish_sborder_fill()
+{
+    if (!sborder_fill_pending) {
+        return;
+    }
+
+    BL_PROFILE("Castro::finish_sborder_fill()");
+
+    Sborder.FillBoundary_finish();
+
+    StateDataPhysBCFunct physbcf(state[State_Type], 0, geom);
+    physbcf(Sborder, 0, NUM_STATE, Sborder.nGrowVect(), sborder_fill_time, 0);
+
+    sborder_fill_pending = false;
+
+    // The valid zones, and the ghost zones filled from other boxes
+    // (including across periodic boundaries), are copies of the old
+    // state, which was already cleaned in initialize_advance, and the
+    // valid zones may have already been used by the tiles updated
+    // while the exchange was in flight.  So we only clean the ghost
+    // zones outside the (periodically grown) domain, which were filled
+    // by the physical boundary conditions.  (The fill is never split
+    // with MHD.)
+
+#ifndef MHD
+    if (!geom.isAllPeriodic()) {
+
+        const int ng = Sborder.nGrow();
+
+        const Box interior = geom.growPeriodicDomain(ng);
+
+#ifdef _OPENMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+        for (MFIter mfi(Sborder, TilingIfNotGPU()); mfi.isValid(); ++mfi) {
+            const Box& gbx = mfi.growntilebox(ng);
+
+            if (interior.contains(gbx)) {
+                continue;
+            }
+
+            auto S = Sborder.array(mfi);
+
+            for (const Box& bx : amrex::boxDiff(gbx, interior)) {
+                clean_state(bx, S);
+            }
+        }
+    }
+#endif
+
+#ifdef SHOCK_VAR
+    // The ghost zones came from neighboring boxes before the shock
+    // variable was zeroed, so zero it again.
+
+    Sborder.setVal(0.0, USHK, 1, Sborder.nGrow());
+#endif
+}
+
 
 void
 Castro::check_for_nan(MultiFab& state_in, int check_ghost)
@@ -4499,6 +5219,26 @@ Castro::clean_state(
 
 }
 
+#ifndef MHD
+void
+Castro::clean_state(const Box& bx, Array4<Real> const u)
+{
+    do_enforce_minimum_density(bx, u, verbose);
+
+    enforce_speed_limit(bx, u);
+
+    normalize_species(bx, u);
+
+#ifdef HYBRID_MOMENTUM
+    if (hybrid_hydro) {
+        hybrid_to_linear_momentum(bx, u);
+    }
+#endif
+
+    computeTemp(bx, u);
+}
+#endif
+
 void
 Castro::save_data_for_retry ()
 {
@@ -81,6 +81,12 @@ Castro::advance (Real time,
 #endif // TRUE_SDC
 #endif // AMREX_USE_GPU
 #endif //MHD    
+#ifdef TRUE_SDC
+    } else if (time_integration_method == LowStorageRungeKutta) {
+
+        dt_new = do_advance_lsrk(time, dt);
+
+#endif
     }
 
     // If the user requests, indicate that we want a regrid at the end of the step.
@@ -122,6 +128,18 @@ Castro::initialize_do_advance (Real time, Real dt)
 
     advance_status status {};
 
+    // Make sure we don't redefine Sborder while a fill from a
+    // previous (rejected) attempt at this advance is still in flight.
+
+    finish_sborder_fill();
+
+#ifdef DIFFUSION
+    // The old-time state may be new to us (or, on a retry, we may have
+    // a different time level), so the cached diffusion data is stale.
+
+    temp_diff_data_is_old = false;
+#endif
+
 #ifdef RADIATION
     // make sure these are filled to avoid check/plot file errors:
     if (do_radiation) {
@@ -166,22 +184,40 @@ Castro::initialize_do_advance (Real time, Real dt)
       // consistent
       Sborder.define(grids, dmap, NUM_STATE, NUM_GROW, MFInfo().SetTag("Sborder"));
       const Real prev_time = state[State_Type].prevTime();
-      expand_state(Sborder, prev_time, NUM_GROW);
-      clean_state(
+
+      if (can_overlap_sborder_fill()) {
+          // the ghost cell exchange (and the cleaning of the ghost
+          // zones) is completed by finish_sborder_fill() once the
+          // ghost data is actually needed
+          start_sborder_fill(prev_time);
+      } else {
+          expand_state(Sborder, prev_time, NUM_GROW);
+          clean_state(
 #ifdef MHD
-                  Bx_old_tmp, By_old_tmp, Bz_old_tmp,
+                      Bx_old_tmp, By_old_tmp, Bz_old_tmp,
 #endif
-                  Sborder, prev_time, NUM_GROW);
+                      Sborder, prev_time, NUM_GROW);
+      }
 
-    } else if (time_integration_method == SpectralDeferredCorrections) {
+    } else if (time_integration_method == SpectralDeferredCorrections ||
+               time_integration_method == LowStorageRungeKutta) {
 
-      // we'll handle the filling inside of do_advance_sdc 
+      // we'll handle the filling inside of do_advance_sdc (or
+      // do_advance_lsrk), once per node (stage)
       Sborder.define(grids, dmap, NUM_STATE, NUM_GROW, MFInfo().SetTag("Sborder"));
 
     } else {
       amrex::Abort("invalid time_integration_method");
     }
 
+    // Finish the diagnostics of the last step, if they were left in
+    // flight (castro.overlap_diagnostics).  On the coarse level this
+    // overlaps with the Sborder exchange if that is also overlapped.
+
+    if (level == 0) {
+        complete_diagnostics();
+    }
+
 #ifdef SHOCK_VAR
     // Zero out the shock data, and fill it during the advance.
     // For subcycling cases this will always give the shock
@@ -251,6 +287,8 @@ Castro::finalize_do_advance (Real time, Real dt)
 
     advance_status status {};
 
+    finish_sborder_fill();
+
     // Check if this timestep violated our stability criteria. Our idea is,
     // if the timestep created a velocity v and sound speed at the new time
     // such that (v+c) * dt / dx < CFL / change_max, where CFL is the user's
@@ -366,6 +404,13 @@ Castro::initialize_advance(Real time, Real dt, int amr_iteration)
     source_corrector.define(grids, dmap, NSRC, NUM_GROW_SRC);
     source_corrector.setVal(0.0, NUM_GROW_SRC);
 
+    // This holds the costs we measure during the step.
+
+    if (Work_Estimate_Type >= 0) {
+        step_cost.define(grids, dmap, 1, 0);
+        step_cost.setVal(0.0);
+    }
+
     // Swap the new data from the last timestep into the old state data.
 
     swap_state_time_levels(dt);
@@ -610,6 +655,9 @@ Castro::finalize_advance()
 
     source_corrector.clear();
 
+    update_work_estimate();
+    step_cost.clear();
+
     if (!keep_prev_state) {
         amrex::FillNull(prev_state);
     }
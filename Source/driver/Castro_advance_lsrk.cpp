@@ -0,0 +1,137 @@
+#include <Castro.H>
+#include <low_storage_rk.H>
+
+#ifdef GRAVITY
+#include <Gravity.H>
+#endif
+
+using namespace amrex;
+
+Real
+Castro::do_advance_lsrk (Real time, Real dt)
+{
+    // Advance the state on this level with a low storage (2N)
+    // Runge-Kutta method of lines integration.  The hydrodynamics
+    // (and the diffusive fluxes) come from the same method of lines
+    // source as the true SDC integration, and the other sources are
+    // evaluated from the stage state and added to it.  Unlike SDC, we
+    // don't keep the solution and the righthand side at each node:
+    // S_new carries the solution through the stages and dU is the
+    // only other register.
+
+    BL_PROFILE("Castro::do_advance_lsrk()");
+
+    const Real prev_time = state[State_Type].prevTime();
+    const Real  cur_time = state[State_Type].curTime();
+
+    MultiFab& S_old = get_old_data(State_Type);
+    MultiFab& S_new = get_new_data(State_Type);
+
+    MultiFab& old_source = get_old_data(Source_Type);
+    MultiFab& new_source = get_new_data(Source_Type);
+
+    advance_status status {};
+
+    // Perform initialization steps.  There is no retry for this
+    // integrator, so like SDC we carry on regardless of the status.
+
+    status = initialize_do_advance(time, dt);
+
+    const low_storage_rk::Method rk = low_storage_rk::method(lsrk_order);
+
+    MultiFab dU(grids, dmap, NUM_STATE, 0, MFInfo().SetTag("lsrk_dU"));
+    dU.setVal(0.0);
+
+    MultiFab::Copy(S_new, S_old, 0, 0, NUM_STATE, 0);
+
+    // The gravitational field is computed from the old state, and
+    // used for all of the stages.
+
+#ifdef GRAVITY
+    construct_old_gravity(prev_time);
+#endif
+
+    bool apply_sources_to_state = false;
+
+    for (int n = 0; n < rk.nstages; ++n) {
+
+        current_lsrk_stage = n;
+
+        const Real stage_time = prev_time + rk.C[n] * dt;
+
+        // Fill Sborder from the stage state.  For the later stages we
+        // point the new time level of the state at the stage time, so
+        // the FillPatch takes the data of this level from S_new as it
+        // is, while the ghost cells at a coarse-fine boundary are
+        // interpolated in time between the coarse old and new data.
+        // The first stage is just the old state.
+
+        if (n > 0) {
+            state[State_Type].setNewTimeLevel(stage_time);
+            clean_state(S_new, stage_time, 0);
+        }
+
+        expand_state(Sborder, stage_time, NUM_GROW);
+
+        if (apply_sources()) {
+            // there is a ghost cell fill hidden in diffusion, so we
+            // pass in the time associated with Sborder
+            do_old_sources(old_source, Sborder, Sborder, stage_time, dt, apply_sources_to_state);
+
+            // the sources are only needed in the valid zones, except for
+            // the well-balanced reconstruction of the pressure
+            if (use_pslope == 1) {
+                AmrLevel::FillPatch(*this, old_source, old_source.nGrow(), prev_time, Source_Type, 0, NSRC);
+            }
+        }
+
+        cons_to_prim(stage_time);
+
+        if (do_hydro && n == 0) {
+            check_for_cfl_violation(S_old, dt);
+        }
+
+        // dU = A_n dU + L(u); the method of lines source adds to its
+        // argument, and A_0 = 0 starts the register over
+
+        if (n > 0) {
+            dU.mult(rk.A[n]);
+        }
+
+        construct_mol_hydro_source(stage_time, dt, dU);
+
+        // u = u + B_n dt dU
+
+        MultiFab::Saxpy(S_new, rk.B[n] * dt, dU, 0, 0, NUM_STATE, 0);
+    }
+
+    state[State_Type].setNewTimeLevel(cur_time);
+
+    clean_state(S_new, cur_time, 0);
+
+#ifdef GRAVITY
+    // The new-time gravitational field, for the plotfiles and as the
+    // starting point of the next step (this also finishes the
+    // composite correction set up in construct_old_gravity).
+
+    construct_new_gravity(cur_time);
+#endif
+
+    // Store the sources of the new state (for the plotfiles).  As for
+    // SDC, these are always constructed with do_old_sources, since we
+    // want the actual source and not a correction.
+
+    if (apply_sources()) {
+        expand_state(Sborder, cur_time, NUM_GROW);
+        do_old_sources(new_source, Sborder, Sborder, cur_time, dt, apply_sources_to_state);
+        AmrLevel::FillPatch(*this, new_source, new_source.nGrow(), cur_time, Source_Type, 0, NSRC);
+    }
+
+    status = finalize_do_advance(cur_time, dt);
+
+    if (!status.success && verbose > 0) {
+        amrex::Print() << "  Low storage Runge-Kutta advance: " << status.reason << std::endl;
+    }
+
+    return dt;
+}
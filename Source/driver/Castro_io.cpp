@@ -150,6 +150,12 @@ Castro::restart (Amr&     papa,
 
     initMFs();
 
+    // the work estimate is not checkpointed; start over with uniform costs
+
+    if (Work_Estimate_Type >= 0) {
+        get_new_data(Work_Estimate_Type).setVal(1.0);
+    }
+
     // get the elapsed CPU time to now;
     if (level == 0 && ParallelDescriptor::IOProcessor())
     {
@@ -222,9 +228,13 @@ Castro::restart (Amr&     papa,
        amrex::Error("Must have max_level > 0 if doing special restart with grown_factor");
     }
 
-    if (grown_factor > 1 && level == 0)
+    // Embiggen may have added more than one coarse level, so the part of
+    // every level outside the original domain is initialized, not just
+    // that of level 0.  The original levels lie inside it.
+
+    if (grown_factor > 1)
     {
-       if (verbose && ParallelDescriptor::IOProcessor()) {
+       if (verbose && ParallelDescriptor::IOProcessor() && level == 0) {
          std::cout << "Doing special restart with grown_factor " << grown_factor << std::endl;
        }
        MultiFab& S_new = get_new_data(State_Type);
@@ -305,8 +315,13 @@ Castro::restart (Amr&     papa,
        }
     }
 
-    if (grown_factor > 1 && level == 1) {
-      getLevel(0).avgDown();
+    // average the data inside the original domain down onto the
+    // levels below, which are already restarted
+
+    if (grown_factor > 1 && level > 0) {
+      for (int lev = level-1; lev >= 0; --lev) {
+        getLevel(lev).avgDown();
+      }
     }
 
 #ifdef GRAVITY
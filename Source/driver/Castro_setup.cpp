@@ -296,7 +296,8 @@ Castro::variableSetUp ()
 #ifdef MHD
   NUM_GROW_SRC = 6;
 #else
-  if (time_integration_method == SpectralDeferredCorrections) {
+  if (time_integration_method == SpectralDeferredCorrections ||
+      time_integration_method == LowStorageRungeKutta) {
       NUM_GROW_SRC = NUM_GROW;
   } else {
       NUM_GROW_SRC = 3;
@@ -389,14 +390,17 @@ Castro::variableSetUp ()
   // tracing on the source terms, we need NUM_GROW_SRC ghost cells to do
   // the reconstruction.  For SDC, on the other hand, we only
   // need 1 (for the fourth-order stuff). Simplified SDC uses the CTU
-  // advance, so it behaves the same way as CTU here.
+  // advance, so it behaves the same way as CTU here, and the low
+  // storage Runge-Kutta integrator uses the same method of lines hydro
+  // source as SDC.
 
   store_in_checkpoint = true;
   int source_ng = 0;
   if (time_integration_method == CornerTransportUpwind || time_integration_method == SimplifiedSpectralDeferredCorrections) {
       source_ng = NUM_GROW_SRC;
   }
-  else if (time_integration_method == SpectralDeferredCorrections) {
+  else if (time_integration_method == SpectralDeferredCorrections ||
+           time_integration_method == LowStorageRungeKutta) {
     if (sdc_order == 2 && use_pslope) {
       source_ng = NUM_GROW_SRC;
     } else {
@@ -733,6 +737,20 @@ Castro::variableSetUp ()
   }
 #endif
 
+  // the measured cost of advancing each zone, for load balancing
+
+  if (load_balance_with_costs) {
+    Work_Estimate_Type = desc_lst.size();
+
+    store_in_checkpoint = false;
+    desc_lst.addDescriptor(Work_Estimate_Type, IndexType::TheCellType(),
+                           StateDescriptor::Point, 0, 1,
+                           &mf_pc_interp, state_data_extrap, store_in_checkpoint);
+
+    set_scalar_bc(bc, phys_bc);
+    desc_lst.setComponent(Work_Estimate_Type, 0, "work_estimate", bc, genericBndryFunc);
+  }
+
   num_state_type = desc_lst.size();
 
   //
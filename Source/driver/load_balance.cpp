@@ -0,0 +1,156 @@
+#include <Castro.H>
+#include <CastroAmr.H>
+
+#include <limits>
+
+using namespace amrex;
+
+void
+Castro::add_box_cost (const MFIter& mfi, Real start)
+{
+    if (Work_Estimate_Type < 0 || step_cost.empty()) {
+        return;
+    }
+
+    // on GPUs the work is asynchronous, so wait for it to finish
+
+    Gpu::streamSynchronize();
+
+    const Box& bx = mfi.tilebox();
+
+    const Real c = (amrex::second() - start) / static_cast<Real>(bx.numPts());
+
+    auto const cost = step_cost.array(mfi);
+
+    amrex::ParallelFor(bx,
+    [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+    {
+        cost(i,j,k) += c;
+    });
+}
+
+void
+Castro::add_level_cost (Real elapsed)
+{
+    if (Work_Estimate_Type < 0 || step_cost.empty()) {
+        return;
+    }
+
+    Long npts = 0;
+    for (MFIter mfi(step_cost); mfi.isValid(); ++mfi) {
+        npts += mfi.validbox().numPts();
+    }
+
+    if (npts > 0) {
+        step_cost.plus(elapsed / static_cast<Real>(npts), 0, 1, 0);
+    }
+}
+
+void
+Castro::update_work_estimate ()
+{
+    if (Work_Estimate_Type < 0 || step_cost.empty()) {
+        return;
+    }
+
+    BL_PROFILE("Castro::update_work_estimate()");
+
+    MultiFab& work = get_new_data(Work_Estimate_Type);
+
+    // the first measurement replaces the uniform initial guess
+
+    const Real w = work_estimate_measured ? load_balance_cost_weight : 1.0_rt;
+
+    MultiFab::LinComb(work, 1.0_rt - w, work, 0, w, step_cost, 0, 0, 1, 0);
+
+    work_estimate_measured = true;
+}
+
+void
+CastroAmr::load_balance ()
+{
+    if (Castro::Work_Estimate_Type < 0 || castro::load_balance_int <= 0 ||
+        levelSteps(0) % castro::load_balance_int != 0 ||
+        ParallelDescriptor::NProcs() == 1) {
+        return;
+    }
+
+    BL_PROFILE("CastroAmr::load_balance()");
+
+    const int root = ParallelDescriptor::IOProcessorNumber();
+
+    int lbase = -1;
+
+    for (int lev = 0; lev <= finestLevel(); ++lev) {
+
+        const MultiFab& work = getLevel(lev).get_new_data(Castro::Work_Estimate_Type);
+
+        // the cost of each of our boxes
+
+        LayoutData<Real> cost(work.boxArray(), work.DistributionMap());
+
+        for (MFIter mfi(work); mfi.isValid(); ++mfi) {
+            auto const w = work.const_array(mfi);
+
+            ReduceOps<ReduceOpSum> reduce_op;
+            ReduceData<Real> reduce_data(reduce_op);
+            using ReduceTuple = typename decltype(reduce_data)::Type;
+
+            reduce_op.eval(mfi.validbox(), reduce_data,
+            [=] AMREX_GPU_HOST_DEVICE (int i, int j, int k) -> ReduceTuple
+            {
+                return {w(i,j,k)};
+            });
+
+            cost[mfi] = amrex::get<0>(reduce_data.value());
+        }
+
+        Real current_efficiency = 0.0;
+        Real proposed_efficiency = 0.0;
+
+        DistributionMapping new_dm;
+
+        if (castro::load_balance_strategy == "sfc") {
+            new_dm = DistributionMapping::makeSFC(cost, current_efficiency, proposed_efficiency, true, root);
+        } else {
+            // unlike makeSFC, the fourth argument here is the maximum
+            // number of boxes per rank
+            new_dm = DistributionMapping::makeKnapSack(cost, current_efficiency, proposed_efficiency,
+                                                       std::numeric_limits<int>::max(), true, root);
+        }
+
+        // the efficiencies are only computed on the root
+
+        ParallelDescriptor::Bcast(&current_efficiency, 1, root);
+        ParallelDescriptor::Bcast(&proposed_efficiency, 1, root);
+
+        // Moving the data is not free, so only do it if the
+        // improvement is substantial.
+
+        const bool rebalance = proposed_efficiency - current_efficiency >= castro::load_balance_min_gain;
+
+        if (castro::verbose > 0) {
+            amrex::Print() << "Load balance on level " << lev << ": efficiency "
+                           << current_efficiency << ", proposed " << proposed_efficiency
+                           << (rebalance ? " (rebalancing)" : " (keeping the current distribution)")
+                           << std::endl;
+        }
+
+        if (rebalance) {
+            InstallNewDistributionMap(lev, new_dm);
+
+            if (lbase < 0) {
+                lbase = lev;
+            }
+        }
+    }
+
+    // as after a regrid, let the levels update what depends on the
+    // distribution (gravity, particles, masks)
+
+    if (lbase >= 0) {
+        for (int lev = lbase; lev <= finestLevel(); ++lev) {
+            getLevel(lev).post_regrid(lbase, finestLevel());
+        }
+    }
+}
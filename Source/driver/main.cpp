@@ -22,6 +22,7 @@
 #include <ctime>
 
 #include <Castro.H>
+#include <CastroAmr.H>
 #include <Castro_io.H>
 
 #include <global.H>
@@ -143,7 +144,7 @@ main (int   argc,
     // Initialize random seed after we're running in parallel.
     //
 
-    Amr* amrptr = new Amr(getLevelBld());
+    CastroAmr* amrptr = new CastroAmr(getLevelBld());
     global::the_amr_ptr = amrptr;
 
     amrptr->init(strt_time,stop_time);
@@ -171,8 +172,15 @@ main (int   argc,
         // Do a timestep.
         //
         amrptr->coarseTimeStep(stop_time);
+
+        amrptr->load_balance();
     }
 
+    // Write out the diagnostics of the last step, if they are still
+    // in flight
+
+    Castro::complete_diagnostics();
+
 #ifdef DO_PROBLEM_POST_SIMULATION
     Castro::problem_post_simulation(amrptr->getAmrLevels());
 #endif
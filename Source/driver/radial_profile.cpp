@@ -0,0 +1,320 @@
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+
+#include <AMReX_MultiFabUtil.H>
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_Utility.H>
+
+#include <radial_profile.H>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+using namespace amrex;
+
+namespace radial_profile
+{
+
+namespace {
+
+    ///
+    /// The radius and volume of zone (i,j,k)
+    ///
+    AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE
+    void
+    zone_radius_volume (int i, int j, int k,
+                        GpuArray<Real, AMREX_SPACEDIM> const& problo,
+                        GpuArray<Real, AMREX_SPACEDIM> const& dx,
+                        GpuArray<Real, 3> const& center,
+                        const int coord, const int radius_type, const int axis,
+                        Real& r, Real& vol)
+    {
+        const int idx[3] = {i, j, k};
+
+        Real x[3] = {center[0], center[1], center[2]};
+        for (int d = 0; d < AMREX_SPACEDIM; ++d) {
+            x[d] = problo[d] + (static_cast<Real>(idx[d]) + 0.5_rt) * dx[d];
+        }
+
+        if (radius_type == planar) {
+            r = x[axis] - center[axis];
+        } else {
+            Real r2 = 0.0_rt;
+            for (int d = 0; d < 3; ++d) {
+                if (radius_type == cylindrical && d == axis) {
+                    continue;
+                }
+                r2 += (x[d] - center[d]) * (x[d] - center[d]);
+            }
+            r = std::sqrt(r2);
+        }
+
+        const Real rl = problo[0] + static_cast<Real>(i) * dx[0];
+        const Real rr = rl + dx[0];
+
+        if (coord == 1) {
+            // axisymmetric: V = pi (r_r**2 - r_l**2) dz
+            vol = M_PI * std::abs(rr * rr - rl * rl);
+#if AMREX_SPACEDIM >= 2
+            vol *= dx[1];
+#endif
+        } else if (coord == 2) {
+            // spherical: V = 4/3 pi (r_r**3 - r_l**3)
+            vol = (4.0_rt / 3.0_rt) * M_PI * std::abs(rr * rr * rr - rl * rl * rl);
+        } else {
+            vol = AMREX_D_TERM(dx[0], * dx[1], * dx[2]);
+        }
+    }
+
+}
+
+Real
+max_radius (const Geometry& geom, const ProfileSpec& spec)
+{
+    const auto problo = geom.ProbLoArray();
+    const auto probhi = geom.ProbHiArray();
+
+    // the furthest point is one of the corners of the domain
+
+    Real rmax = 0.0_rt;
+
+    for (int corner = 0; corner < (1 << AMREX_SPACEDIM); ++corner) {
+        Real x[3] = {spec.center[0], spec.center[1], spec.center[2]};
+        for (int d = 0; d < AMREX_SPACEDIM; ++d) {
+            x[d] = (corner & (1 << d)) ? probhi[d] : problo[d];
+        }
+
+        Real r;
+        if (spec.radius_type == planar) {
+            r = x[spec.axis] - spec.center[spec.axis];
+        } else {
+            Real r2 = 0.0_rt;
+            for (int d = 0; d < 3; ++d) {
+                if (spec.radius_type == cylindrical && d == spec.axis) {
+                    continue;
+                }
+                r2 += (x[d] - spec.center[d]) * (x[d] - spec.center[d]);
+            }
+            r = std::sqrt(r2);
+        }
+
+        rmax = amrex::max(rmax, r);
+    }
+
+    return rmax;
+}
+
+void
+set_default_bins (const Geometry& fine_geom, ProfileSpec& spec)
+{
+    if (spec.dr <= 0.0_rt) {
+        const auto dx = fine_geom.CellSizeArray();
+        spec.dr = *(std::min_element(dx.begin(), dx.end()));
+    }
+
+    if (spec.nbins <= 0) {
+        if (spec.radius_type == planar) {
+            // start from the bottom of the domain
+            spec.rmin = fine_geom.ProbLo(spec.axis) - spec.center[spec.axis];
+        }
+        spec.nbins = static_cast<int>(std::ceil((max_radius(fine_geom, spec) - spec.rmin) / spec.dr));
+        spec.nbins = amrex::max(spec.nbins, 1);
+    }
+}
+
+Profile
+compute (const Vector<const MultiFab*>& data,
+         const Vector<Geometry>& geom,
+         const Vector<IntVect>& ref_ratio,
+         const Vector<int>& comps,
+         const ProfileSpec& spec)
+{
+    BL_PROFILE("radial_profile::compute()");
+
+    AMREX_ALWAYS_ASSERT(spec.dr > 0.0_rt && spec.nbins > 0);
+
+    if (spec.weight_type == mass && spec.density_comp < 0) {
+        amrex::Error("radial_profile: mass weighting needs density_comp");
+    }
+
+    const int nlevs = data.size();
+    const int ncomp = comps.size();
+    const int nbins = spec.nbins;
+
+    // the bins hold the weighted sum of each variable, followed by the
+    // sum of the weights
+
+    const int nsum = (ncomp + 1) * nbins;
+
+    Gpu::ManagedVector<Real> bins(nsum, 0.0_rt);
+
+    Gpu::ManagedVector<int> comps_v(ncomp);
+    for (int n = 0; n < ncomp; ++n) {
+        comps_v[n] = comps[n];
+    }
+    const int* const comps_p = comps_v.dataPtr();
+
+    GpuArray<Real, 3> center = {spec.center[0], spec.center[1], spec.center[2]};
+
+    const int radius_type = spec.radius_type;
+    const int axis = spec.axis;
+    const bool mass_weight = spec.weight_type == mass;
+    const int density_comp = spec.density_comp;
+    const Real rmin = spec.rmin;
+    const Real drinv = 1.0_rt / spec.dr;
+
+#ifdef _OPENMP
+    int nthreads = omp_get_max_threads();
+    Vector<Gpu::ManagedVector<Real>> priv_bins(nthreads);
+    for (int i = 0; i < nthreads; i++) {
+        priv_bins[i].resize(nsum, 0.0_rt);
+    }
+#endif
+
+    for (int lev = 0; lev < nlevs; ++lev) {
+
+        const MultiFab& mf = *data[lev];
+
+        // zones covered by the next finer level are left to it
+
+        const bool has_mask = lev < nlevs - 1;
+
+        iMultiFab mask;
+        if (has_mask) {
+            mask = makeFineMask(mf.boxArray(), mf.DistributionMap(),
+                                data[lev+1]->boxArray(), ref_ratio[lev], 1, 0);
+        }
+
+        const auto problo = geom[lev].ProbLoArray();
+        const auto dx = geom[lev].CellSizeArray();
+        const int coord = geom[lev].Coord();
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        {
+#ifdef _OPENMP
+            Real* const b = priv_bins[omp_get_thread_num()].dataPtr();
+#else
+            Real* const b = bins.dataPtr();
+#endif
+
+            for (MFIter mfi(mf, TilingIfNotGPU()); mfi.isValid(); ++mfi)
+            {
+                const Box& bx = mfi.tilebox();
+
+                auto const q = mf.const_array(mfi);
+                auto const m = has_mask ? mask.const_array(mfi) : Array4<int const>{};
+
+                amrex::ParallelFor(bx,
+                [=] AMREX_GPU_HOST_DEVICE (int i, int j, int k) noexcept
+                {
+                    if (has_mask && m(i,j,k) == 0) {
+                        return;
+                    }
+
+                    Real r, vol;
+                    zone_radius_volume(i, j, k, problo, dx, center,
+                                       coord, radius_type, axis, r, vol);
+
+                    const Real fbin = std::floor((r - rmin) * drinv);
+                    if (fbin < 0.0_rt || fbin >= static_cast<Real>(nbins)) {
+                        return;
+                    }
+                    const int index = static_cast<int>(fbin);
+
+                    const Real w = mass_weight ? vol * q(i,j,k,density_comp) : vol;
+
+                    for (int n = 0; n < ncomp; ++n) {
+                        Gpu::Atomic::Add(&b[n * nbins + index], w * q(i,j,k,comps_p[n]));
+                    }
+                    Gpu::Atomic::Add(&b[ncomp * nbins + index], w);
+                });
+            }
+        }
+    }
+
+#ifdef _OPENMP
+#pragma omp parallel for
+    for (int i = 0; i < nsum; i++) {
+        for (int it = 0; it < nthreads; it++) {
+            bins[i] += priv_bins[it][i];
+        }
+    }
+#endif
+
+    Gpu::streamSynchronize();
+
+    ParallelDescriptor::ReduceRealSum(bins.dataPtr(), nsum);
+
+    // normalize
+
+    Profile profile;
+
+    profile.r.resize(nbins);
+    profile.weight.resize(nbins);
+    profile.data.resize(ncomp);
+
+    for (int i = 0; i < nbins; ++i) {
+        profile.r[i] = spec.rmin + (static_cast<Real>(i) + 0.5_rt) * spec.dr;
+        profile.weight[i] = bins[ncomp * nbins + i];
+    }
+
+    for (int n = 0; n < ncomp; ++n) {
+        profile.data[n].resize(nbins, 0.0_rt);
+        for (int i = 0; i < nbins; ++i) {
+            if (profile.weight[i] > 0.0_rt) {
+                profile.data[n][i] = bins[n * nbins + i] / profile.weight[i];
+            }
+        }
+    }
+
+    return profile;
+}
+
+void
+write (const std::string& filename, const Profile& profile,
+       const Vector<std::string>& names)
+{
+    if (!ParallelDescriptor::IOProcessor()) {
+        return;
+    }
+
+    std::ofstream outfile;
+    outfile.open(filename);
+    if (!outfile.good()) {
+        amrex::FileOpenFailed(filename);
+    }
+
+    outfile.setf(std::ios::scientific);
+    outfile.precision(12);
+    const int w = 24;
+
+    // write the header
+
+    outfile << "# " << std::setw(w) << "r" << std::setw(w) << "weight";
+    for (const auto& name : names) {
+        outfile << std::setw(w) << name;
+    }
+    outfile << std::endl;
+
+    // write the data in columns
+
+    for (int i = 0; i < static_cast<int>(profile.r.size()); ++i) {
+        if (profile.weight[i] <= 0.0_rt) {
+            continue;
+        }
+
+        outfile << "  " << std::setw(w) << profile.r[i] << std::setw(w) << profile.weight[i];
+        for (const auto& d : profile.data) {
+            outfile << std::setw(w) << d[i];
+        }
+        outfile << std::endl;
+    }
+
+    outfile.close();
+}
+
+}
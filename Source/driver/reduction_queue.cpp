@@ -0,0 +1,146 @@
+#include <reduction_queue.H>
+
+using namespace amrex;
+
+ReductionQueue::~ReductionQueue ()
+{
+    // We don't complete() here: Castro::diagnostics_reductions is static,
+    // so it is destroyed after MPI is finalized.
+
+    AMREX_ASSERT_WITH_MESSAGE(state == Filling && vals.empty() && callbacks.empty(),
+                              "ReductionQueue: destroyed before complete()");
+}
+
+int
+ReductionQueue::add (Real val, Op op)
+{
+    return add(&val, 1, op);
+}
+
+int
+ReductionQueue::add (const Real* v, int n, Op op)
+{
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(state == Filling,
+                                     "ReductionQueue: cannot add values once the reduction has started");
+
+    const int handle = vals.size();
+
+    for (int i = 0; i < n; ++i) {
+        vals.push_back(v[i]);
+        ops.push_back(op);
+    }
+
+    return handle;
+}
+
+void
+ReductionQueue::start ()
+{
+    if (state != Filling) {
+        return;
+    }
+
+    BL_PROFILE("ReductionQueue::start()");
+
+    // min and max go together (min x = -max(-x)); sums go on their own
+
+    const int n = vals.size();
+
+    max_buf.clear();
+    sum_buf.clear();
+    slot.resize(n);
+
+    for (int i = 0; i < n; ++i) {
+        if (ops[i] == Sum) {
+            slot[i] = sum_buf.size();
+            sum_buf.push_back(vals[i]);
+        } else {
+            slot[i] = max_buf.size();
+            max_buf.push_back(ops[i] == Min ? -vals[i] : vals[i]);
+        }
+    }
+
+#ifdef BL_USE_MPI
+    if (ParallelDescriptor::NProcs() > 1) {
+
+        const MPI_Comm comm = ParallelDescriptor::Communicator();
+        const MPI_Datatype dtype = ParallelDescriptor::Mpi_typemap<Real>::type();
+
+        if (!max_buf.empty()) {
+            MPI_Iallreduce(MPI_IN_PLACE, max_buf.dataPtr(), static_cast<int>(max_buf.size()),
+                           dtype, MPI_MAX, comm, &requests[0]);
+        }
+
+        if (!sum_buf.empty()) {
+            MPI_Iallreduce(MPI_IN_PLACE, sum_buf.dataPtr(), static_cast<int>(sum_buf.size()),
+                           dtype, MPI_SUM, comm, &requests[1]);
+        }
+    }
+#endif
+
+    state = Started;
+}
+
+void
+ReductionQueue::wait ()
+{
+    if (state == Filling) {
+        start();
+    }
+
+    if (state == Done) {
+        return;
+    }
+
+    BL_PROFILE("ReductionQueue::wait()");
+
+#ifdef BL_USE_MPI
+    MPI_Waitall(2, requests, MPI_STATUSES_IGNORE);
+#endif
+
+    for (int i = 0; i < static_cast<int>(vals.size()); ++i) {
+        if (ops[i] == Sum) {
+            vals[i] = sum_buf[slot[i]];
+        } else if (ops[i] == Min) {
+            vals[i] = -max_buf[slot[i]];
+        } else {
+            vals[i] = max_buf[slot[i]];
+        }
+    }
+
+    state = Done;
+}
+
+Real
+ReductionQueue::get (int handle)
+{
+    AMREX_ASSERT(handle >= 0 && handle < static_cast<int>(vals.size()));
+
+    wait();
+
+    return vals[handle];
+}
+
+void
+ReductionQueue::then (std::function<void()> f)
+{
+    callbacks.push_back(std::move(f));
+}
+
+void
+ReductionQueue::complete ()
+{
+    wait();
+
+    // The callbacks read the results with get(), so the queue stays
+    // Done (and no values can be added) until they have all run.
+
+    for (auto& f : callbacks) {
+        f();
+    }
+
+    callbacks.clear();
+    vals.clear();
+    ops.clear();
+    state = Filling;
+}
@@ -19,6 +19,16 @@ Castro::sum_integrated_quantities ()
 
     BL_PROFILE("Castro::sum_integrated_quantities()");
 
+    // The sums and extrema below are reduced over the ranks through the
+    // diagnostics queue, and the output is written once the reductions
+    // are done.  With castro.overlap_diagnostics, that is deferred to
+    // the next step (see complete_diagnostics).  Finish anything left
+    // over from the last call first.
+
+    complete_diagnostics();
+
+    ReductionQueue& rq = diagnostics_reductions;
+
     bool local_flag = true;
 
     int finest_level = parent->finestLevel();
@@ -223,13 +233,18 @@ Castro::sum_integrated_quantities ()
 
         Real foo_max[nfoo_max] = {T_max, rho_max, ts_te_max};
 
-#ifdef BL_LAZY
-        Lazy::QueueReduction( [=] () mutable {
-#endif
+        const int foo_h = rq.add(foo, nfoo, ReductionQueue::Sum);
+        const int foo_max_h = rq.add(foo_max, nfoo_max, ReductionQueue::Max);
 
-        ParallelDescriptor::ReduceRealSum(foo, nfoo, ParallelDescriptor::IOProcessorNumber());
+        rq.then([=] () mutable {
 
-        ParallelDescriptor::ReduceRealMax(foo_max, nfoo_max, ParallelDescriptor::IOProcessorNumber());
+        for (int n = 0; n < nfoo; ++n) {
+            foo[n] = diagnostics_reductions.get(foo_h + n);
+        }
+
+        for (int n = 0; n < nfoo_max; ++n) {
+            foo_max[n] = diagnostics_reductions.get(foo_max_h + n);
+        }
 
         if (ParallelDescriptor::IOProcessor()) {
 
@@ -424,9 +439,7 @@ Castro::sum_integrated_quantities ()
 
             }
         }
-#ifdef BL_LAZY
         });
-#endif
     }
 
 #ifdef GRAVITY
@@ -465,14 +478,16 @@ Castro::sum_integrated_quantities ()
         foo_sum[4] = h_plus_3;
         foo_sum[5] = h_cross_3;
 
-        amrex::ParallelDescriptor::ReduceRealSum(foo_sum.dataPtr(), nfoo_sum);
+        const int foo_sum_h = rq.add(foo_sum.dataPtr(), nfoo_sum, ReductionQueue::Sum);
+
+        rq.then([=] () mutable {
 
-        h_plus_1   = foo_sum[0];
-        h_cross_1  = foo_sum[1];
-        h_plus_2   = foo_sum[2];
-        h_cross_2  = foo_sum[3];
-        h_plus_3   = foo_sum[4];
-        h_cross_3  = foo_sum[5];
+        h_plus_1   = diagnostics_reductions.get(foo_sum_h + 0);
+        h_cross_1  = diagnostics_reductions.get(foo_sum_h + 1);
+        h_plus_2   = diagnostics_reductions.get(foo_sum_h + 2);
+        h_cross_2  = diagnostics_reductions.get(foo_sum_h + 3);
+        h_plus_3   = diagnostics_reductions.get(foo_sum_h + 4);
+        h_cross_3  = diagnostics_reductions.get(foo_sum_h + 5);
 
         if (ParallelDescriptor::IOProcessor()) {
 
@@ -538,6 +553,7 @@ Castro::sum_integrated_quantities ()
             log << std::endl;
 
         }
+        });
 
     }
 #endif
@@ -573,10 +589,12 @@ Castro::sum_integrated_quantities ()
             foo_sum[i] = species_mass[i];
         }
 
-        amrex::ParallelDescriptor::ReduceRealSum(foo_sum.dataPtr(), nfoo_sum);
+        const int foo_sum_h = rq.add(foo_sum.dataPtr(), nfoo_sum, ReductionQueue::Sum);
+
+        rq.then([=] () mutable {
 
         for (int i = 0; i < NumSpec; ++i) {
-            species_mass[i] = foo_sum[i];
+            species_mass[i] = diagnostics_reductions.get(foo_sum_h + i);
         }
 
         if (ParallelDescriptor::IOProcessor()) {
@@ -646,6 +664,7 @@ Castro::sum_integrated_quantities ()
             log << std::endl;
 
         }
+        });
 
     }
 
@@ -664,10 +683,10 @@ Castro::sum_integrated_quantities ()
 
 #ifdef AMREX_USE_GPU
         Long gpu_size_free_MB = Gpu::Device::freeMemAvailable() / (1024 * 1024);
-        ParallelDescriptor::ReduceLongMin(gpu_size_free_MB, ParallelDescriptor::IOProcessorNumber());
+        const int gpu_free_h = rq.add(static_cast<Real>(gpu_size_free_MB), ReductionQueue::Min);
 
         Long gpu_size_used_MB = (Gpu::Device::totalGlobalMem() - Gpu::Device::freeMemAvailable()) / (1024 * 1024);
-        ParallelDescriptor::ReduceLongMax(gpu_size_used_MB, ParallelDescriptor::IOProcessorNumber());
+        const int gpu_used_h = rq.add(static_cast<Real>(gpu_size_used_MB), ReductionQueue::Max);
 #endif
 
         // Calculate maximum number of advance subcycles across all levels.
@@ -679,6 +698,13 @@ Castro::sum_integrated_quantities ()
             }
         }
 
+        rq.then([=] () mutable {
+
+#ifdef AMREX_USE_GPU
+        gpu_size_free_MB = static_cast<Long>(diagnostics_reductions.get(gpu_free_h));
+        gpu_size_used_MB = static_cast<Long>(diagnostics_reductions.get(gpu_used_h));
+#endif
+
         if (ParallelDescriptor::IOProcessor()) {
 
             std::ostream& log = *Castro::data_logs[3];
@@ -741,7 +767,7 @@ Castro::sum_integrated_quantities ()
             log << std::fixed;
 
             log << std::setw(fixwidth) << std::setprecision(datprecision) << dt;
-            log << std::setw(intwidth)                                    << parent->finestLevel();
+            log << std::setw(intwidth)                                    << finest_level;
             log << std::setw(fixwidth)                                    << max_num_subcycles;
             log << std::setw(datwidth) << std::setprecision(datprecision) << wall_time;
 #ifdef AMREX_USE_GPU
@@ -752,8 +778,24 @@ Castro::sum_integrated_quantities ()
             log << std::endl;
 
         }
+        });
+
+    }
 
+    if (overlap_diagnostics == 1) {
+        rq.start();
+    } else {
+        rq.complete();
     }
 
     problem_diagnostics();
 }
+
+
+void
+Castro::complete_diagnostics ()
+{
+    BL_PROFILE("Castro::complete_diagnostics()");
+
+    diagnostics_reductions.complete();
+}
@@ -2,6 +2,7 @@
 
 #include <Castro.H>
 #include <Castro_util.H>
+#include <radial_profile.H>
 
 #ifdef GRAVITY
 #include <Gravity.H>
@@ -599,3 +600,151 @@ Castro::gwstrain (Real time,
     }
 }
 #endif
+
+void
+Castro::print_state_memory_footprint ()
+{
+    BL_PROFILE("Castro::print_state_memory_footprint()");
+
+    // Sum up the bytes held in the State_Type data (old and new time
+    // levels) and the per-level flux accumulators over all levels, and
+    // report how much of it is taken by the species and auxiliary
+    // components.
+
+    const int finest_level = parent->finestLevel();
+
+    const int nspec_comp = NumSpec + NumAux;
+
+    Long state_cells = 0;
+    Long flux_faces = 0;
+
+    // the level-wide arrays that the time integration method allocates
+    // for each step, in component-zones (including ghost zones)
+    Real work_zones = 0.0_rt;
+
+    for (int lev = 0; lev <= finest_level; ++lev) {
+        Castro& c_lev = getLevel(lev);
+
+        const MultiFab& S_new = c_lev.get_new_data(State_Type);
+
+        auto zones = [&] (int ng) -> Real {
+            BoxArray ba(S_new.boxArray());
+            ba.grow(ng);
+            return static_cast<Real>(ba.numPts());
+        };
+
+        // Sborder
+        work_zones += NUM_STATE * zones(NUM_GROW);
+
+        if (time_integration_method == CornerTransportUpwind ||
+            time_integration_method == SimplifiedSpectralDeferredCorrections) {
+            // source_corrector
+            work_zones += NSRC * zones(NUM_GROW_SRC);
+        }
+#ifdef TRUE_SDC
+        else {
+            // the primitive variables
+            work_zones += (NQ + NQAUX) * zones(NUM_GROW);
+
+            if (time_integration_method == SpectralDeferredCorrections) {
+                // k_new, A_old, A_new (node 0 of k_new and A_new are aliases)
+                work_zones += (3 * SDC_NODES - 2) * NUM_STATE * zones(0);
+#ifdef REACTIONS
+                // R_old and Sburn
+                work_zones += SDC_NODES * NUM_STATE * zones(0) + NUM_STATE * zones(2);
+#endif
+                if (sdc_order == 4) {
+                    work_zones += (NQ + NQAUX) * zones(NUM_GROW);
+                }
+            } else {
+                // the Runge-Kutta register
+                work_zones += NUM_STATE * zones(0);
+            }
+        }
+#endif
+
+        Long nstate = S_new.boxArray().numPts();
+        if (c_lev.get_state_data(State_Type).hasOldData()) {
+            nstate *= 2;
+        }
+        state_cells += nstate;
+
+        for (int dir = 0; dir < AMREX_SPACEDIM; ++dir) {
+            flux_faces += c_lev.fluxes[dir]->boxArray().numPts();
+        }
+    }
+
+    const Real bytes_per_comp = static_cast<Real>(sizeof(Real));
+
+    const Real state_bytes = static_cast<Real>(state_cells) * NUM_STATE * bytes_per_comp;
+    const Real flux_bytes = static_cast<Real>(flux_faces) * NUM_STATE * bytes_per_comp;
+
+    const Real spec_bytes = static_cast<Real>(state_cells + flux_faces) * nspec_comp * bytes_per_comp;
+
+    const Real total_bytes = state_bytes + flux_bytes;
+    const Real to_MB = 1.0_rt / (1024.0_rt * 1024.0_rt);
+
+    amrex::Print() << std::endl;
+    amrex::Print() << "State memory footprint (all ranks, all levels):" << std::endl;
+    amrex::Print() << "   components: " << NUM_STATE << ", of which species/aux: " << nspec_comp << std::endl;
+    amrex::Print() << "   State_Type data:   " << state_bytes * to_MB << " MB" << std::endl;
+    amrex::Print() << "   flux accumulators: " << flux_bytes * to_MB << " MB" << std::endl;
+    amrex::Print() << "   species/aux share: " << spec_bytes * to_MB << " MB ("
+                   << 100.0_rt * spec_bytes / total_bytes << "%)" << std::endl;
+    amrex::Print() << "   time integrator work arrays (per step): "
+                   << work_zones * bytes_per_comp * to_MB << " MB" << std::endl;
+    amrex::Print() << std::endl;
+}
+
+radial_profile::Profile
+Castro::get_radial_profile (const Vector<std::string>& names, Real time,
+                            radial_profile::ProfileSpec spec)
+{
+    BL_PROFILE("Castro::get_radial_profile()");
+
+    const int finest_level = parent->finestLevel();
+
+    const int nvar = names.size();
+    const bool mass_weight = spec.weight_type == radial_profile::mass;
+
+    // gather the derived quantities (and the density, if we weight by
+    // mass) on every level into one MultiFab per level
+
+    Vector<std::unique_ptr<MultiFab>> data(finest_level + 1);
+    Vector<const MultiFab*> data_p(finest_level + 1);
+    Vector<Geometry> geoms(finest_level + 1);
+    Vector<IntVect> ref_ratio(finest_level);
+
+    Vector<std::string> all_names(names);
+    if (mass_weight) {
+        all_names.push_back("density");
+        spec.density_comp = nvar;
+    }
+
+    for (int lev = 0; lev <= finest_level; ++lev) {
+        Castro& ca_lev = getLevel(lev);
+
+        data[lev] = std::make_unique<MultiFab>(ca_lev.grids, ca_lev.dmap, all_names.size(), 0);
+
+        for (int n = 0; n < static_cast<int>(all_names.size()); ++n) {
+            auto mf = ca_lev.derive(all_names[n], time, 0);
+            BL_ASSERT(mf);
+            MultiFab::Copy(*data[lev], *mf, 0, n, 1, 0);
+        }
+
+        data_p[lev] = data[lev].get();
+        geoms[lev] = parent->Geom(lev);
+        if (lev < finest_level) {
+            ref_ratio[lev] = parent->refRatio(lev);
+        }
+    }
+
+    radial_profile::set_default_bins(parent->Geom(finest_level), spec);
+
+    Vector<int> comps(nvar);
+    for (int n = 0; n < nvar; ++n) {
+        comps[n] = n;
+    }
+
+    return radial_profile::compute(data_p, geoms, ref_ratio, comps, spec);
+}
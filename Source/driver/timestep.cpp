@@ -40,6 +40,12 @@ Castro::estdt_cfl (int is_new)
 
   auto const& ua = stateMF.const_arrays();
 
+  // the sound speed of zones unchanged since computeTemp is in the thermo cache
+
+  const bool use_thermo = thermo_cache_matches(stateMF);
+  auto const& tca = use_thermo ? thermo_cache.const_arrays() : ua;
+  const Real thermo_rtol = castro::thermo_cache_rtol;
+
   auto r = amrex::ParReduce(TypeList<ReduceOpMin>{}, TypeList<ValLocPair<Real, IntVect>>{}, stateMF,
   [=] AMREX_GPU_DEVICE (int box_no, int i, int j, int k) -> GpuTuple<ValLocPair<Real, IntVect>>
   {
@@ -63,7 +69,9 @@ Castro::estdt_cfl (int is_new)
       }
 #endif
 
-      eos(eos_input_re, eos_state);
+      if (!(use_thermo && thermo_cache::load(tca[box_no], i, j, k, eos_state, thermo_rtol))) {
+          eos(eos_input_re, eos_state);
+      }
 
       // Compute velocity and then calculate CFL timestep.
 
@@ -105,6 +105,7 @@ Castro::ctu_ppm_states(const Box& bx, const Box& vbx,
 #if AMREX_SPACEDIM < 3
                        Array4<Real const> const& dloga,
 #endif
+                       const bool uniform_composition,
                        const Real dt) {
 
   // Compute the normal interface states by reconstructing
@@ -122,7 +123,7 @@ Castro::ctu_ppm_states(const Box& bx, const Box& vbx,
 #if AMREX_SPACEDIM <= 2
                 dloga,
 #endif
-                vbx, dt);
+                vbx, uniform_composition, dt);
 
       enforce_reflect_states(bx, 0, qxm, qxp);
 
@@ -135,7 +136,7 @@ Castro::ctu_ppm_states(const Box& bx, const Box& vbx,
 #if AMREX_SPACEDIM <= 2
                 dloga,
 #endif
-                vbx, dt);
+                vbx, uniform_composition, dt);
 
       enforce_reflect_states(bx, 1, qym, qyp);
 #endif
@@ -147,7 +148,7 @@ Castro::ctu_ppm_states(const Box& bx, const Box& vbx,
                 idir,
                 U_arr, rho_inv_arr, q_arr, qaux_arr, srcQ,
                 qzm, qzp,
-                vbx, dt);
+                vbx, uniform_composition, dt);
 
       enforce_reflect_states(bx, 2, qzm, qzp);
 #endif
@@ -247,6 +248,7 @@ Castro::ctu_plm_states(const Box& bx, const Box& vbx,
 #if AMREX_SPACEDIM < 3
                        Array4<Real const> const& dloga,
 #endif
+                       const bool uniform_composition,
                        const Real dt) {
 
   // Compute the normal interface states by reconstructing
@@ -277,7 +279,7 @@ Castro::ctu_plm_states(const Box& bx, const Box& vbx,
 #if AMREX_SPACEDIM < 3
                 dloga,
 #endif
-                srcQ, vbx, dt);
+                srcQ, vbx, uniform_composition, dt);
 
       enforce_reflect_states(bx, 0, qxm, qxp);
 
@@ -289,7 +291,7 @@ Castro::ctu_plm_states(const Box& bx, const Box& vbx,
 #if AMREX_SPACEDIM < 3
                 dloga,
 #endif
-                srcQ, vbx, dt);
+                srcQ, vbx, uniform_composition, dt);
 
       enforce_reflect_states(bx, 1, qym, qyp);
 #endif
@@ -299,7 +301,7 @@ Castro::ctu_plm_states(const Box& bx, const Box& vbx,
       trace_plm(bx, 2,
                 U_arr, rho_inv_arr, q_arr, qaux_arr,
                 qzm, qzp,
-                srcQ, vbx, dt);
+                srcQ, vbx, uniform_composition, dt);
 
       enforce_reflect_states(bx, 2, qzm, qzp);
 #endif
@@ -122,6 +122,19 @@ Castro::construct_ctu_hydro_source(Real time, Real dt)
    }
 #endif
 
+  // If the ghost cell fill of Sborder is still in flight, do the
+  // update in two passes: first the tiles whose stencil only touches
+  // the valid data of their box, and then, after completing the fill,
+  // the tiles that need the ghost zones.
+
+  const int num_passes = sborder_fill_pending ? 2 : 1;
+
+  for (int pass = 0; pass < num_passes; ++pass) {
+
+  if (pass == 1) {
+      finish_sborder_fill();
+  }
+
 #ifdef _OPENMP
 #ifdef RADIATION
 #pragma omp parallel reduction(max:nstep_fsp)
@@ -178,11 +191,22 @@ Castro::construct_ctu_hydro_source(Real time, Real dt)
 
     MultiFab& old_source = get_old_data(Source_Type);
 
+    const bool use_thermo = thermo_cache_matches(Sborder);
+
     for (MFIter mfi(S_new, hydro_tile_size); mfi.isValid(); ++mfi) {
 
       // the valid region box
       const Box& bx = mfi.tilebox();
 
+      if (num_passes == 2) {
+          const bool needs_ghost_zones = !mfi.validbox().contains(amrex::grow(bx, NUM_GROW));
+          if (needs_ghost_zones != (pass == 1)) {
+              continue;
+          }
+      }
+
+      const Real cost_start = Work_Estimate_Type >= 0 ? amrex::second() : 0.0_rt;
+
       const Box& obx = amrex::grow(bx, 1);
 
       // Compute the primitive variables (both q and qaux) from
@@ -224,7 +248,8 @@ Castro::construct_ctu_hydro_source(Real time, Real dt)
 #ifdef RADIATION
               Erborder.array(mfi), lamborder.array(mfi),
 #endif
-              q_arr, qaux_arr);
+              q_arr, qaux_arr,
+              use_thermo ? thermo_cache.const_array(mfi) : Array4<Real const>{});
 
 #if AMREX_SPACEDIM == 2
       Array4<Real const> const areax_arr = area[0].array(mfi);
@@ -328,6 +353,18 @@ Castro::construct_ctu_hydro_source(Real time, Real dt)
       Array4<Real> const qzm_arr = qzm.array();
       Array4<Real> const qzp_arr = qzp.array();
 
+#endif
+
+      // If the composition is uniform over the region the
+      // reconstruction stencils touch, we can skip reconstructing the
+      // species; their fluxes then just follow the mass flux.
+
+      bool uniform_composition = false;
+
+#ifndef AMREX_USE_GPU
+      if (uniform_composition_tol >= 0.0_rt) {
+          uniform_composition = composition_is_uniform(qbx3, U_old_arr, rho_inv_arr);
+      }
 #endif
 
       if (ppm_type == 0) {
@@ -347,6 +384,7 @@ Castro::construct_ctu_hydro_source(Real time, Real dt)
 #if (AMREX_SPACEDIM < 3)
                        dLogArea_arr,
 #endif
+                       uniform_composition,
                        dt);
 
       } else {
@@ -381,6 +419,7 @@ Castro::construct_ctu_hydro_source(Real time, Real dt)
 #if AMREX_SPACEDIM < 3
                        dLogArea_arr,
 #endif
+                       uniform_composition,
                        dt);
 #endif
 
@@ -1449,10 +1488,16 @@ Castro::construct_ctu_hydro_source(Real time, Real dt)
       }
 #endif
 
+      if (Work_Estimate_Type >= 0) {
+          add_box_cost(mfi, cost_start);
+      }
+
     } // MFIter loop
 
   } // OMP loop
 
+  } // pass loop
+
 #ifdef RADIATION
   if (radiation->verbose>=1) {
 #ifdef BL_LAZY
@@ -1475,9 +1520,10 @@ Castro::construct_ctu_hydro_source(Real time, Real dt)
   }
 #endif
 
-  // Check for small/negative densities and X > 1 or X < 0.
+  // Check the validity of the new state (small/negative densities,
+  // X > 1 or X < 0, ...) before clean_state resets it.
 
-  status = check_for_negative_density();
+  status = check_state_validity(false);
 
   if (status.success == false) {
       return status;
@@ -1491,9 +1537,15 @@ Castro::construct_ctu_hydro_source(Real time, Real dt)
 #endif
                S_new, time + dt, 0);
 
-  // Check for NaN's.
+  // Check for NaNs (which survive clean_state, and which computeTemp
+  // and the energy resets can produce) and the temperature bounds,
+  // now that the temperature is up to date.
+
+  status = check_state_validity(true);
 
-  check_for_nan(S_new);
+  if (status.success == false) {
+      return status;
+  }
 
 #ifdef GRAVITY
   // Must define new value of "center" after advecting on the grid
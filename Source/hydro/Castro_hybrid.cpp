@@ -176,8 +176,6 @@ Castro::hybrid_to_linear_momentum(MultiFab& state_in, int ng)
 {
     BL_PROFILE("Castro::hybrid_to_linear_momentum()");
 
-    GeometryData geomdata = geom.data();
-
 #ifdef _OPENMP
 #pragma omp parallel
 #endif
@@ -185,32 +183,40 @@ Castro::hybrid_to_linear_momentum(MultiFab& state_in, int ng)
     {
         const Box& bx = mfi.growntilebox(ng);
 
-        auto u = state_in.array(mfi);
+        hybrid_to_linear_momentum(bx, state_in.array(mfi));
+    }
+}
 
-        // Convert hybrid momentum to linear momentum.
 
-        amrex::ParallelFor(bx,
-        [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
-        {
-            GpuArray<Real, 3> loc;
 
-            position(i, j, k, geomdata, loc);
+void
+Castro::hybrid_to_linear_momentum(const Box& bx, Array4<Real> const u)
+{
+    GeometryData geomdata = geom.data();
 
-            for (int dir = 0; dir < AMREX_SPACEDIM; ++dir)
-                loc[dir] -= problem::center[dir];
+    // Convert hybrid momentum to linear momentum.
 
-            GpuArray<Real, 3> hybrid_mom;
+    amrex::ParallelFor(bx,
+    [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+    {
+        GpuArray<Real, 3> loc;
 
-            for (int dir = 0; dir < 3; ++dir)
-                hybrid_mom[dir] = u(i,j,k,UMR+dir);
+        position(i, j, k, geomdata, loc);
 
-            GpuArray<Real, 3> linear_mom;
+        for (int dir = 0; dir < AMREX_SPACEDIM; ++dir)
+            loc[dir] -= problem::center[dir];
 
-            hybrid_to_linear(loc, hybrid_mom, linear_mom);
+        GpuArray<Real, 3> hybrid_mom;
 
-            for (int dir = 0; dir < 3; ++dir)
-                u(i,j,k,UMX+dir) = linear_mom[dir];
+        for (int dir = 0; dir < 3; ++dir)
+            hybrid_mom[dir] = u(i,j,k,UMR+dir);
 
-        });
-    }
+        GpuArray<Real, 3> linear_mom;
+
+        hybrid_to_linear(loc, hybrid_mom, linear_mom);
+
+        for (int dir = 0; dir < 3; ++dir)
+            u(i,j,k,UMX+dir) = linear_mom[dir];
+
+    });
 }
@@ -27,6 +27,8 @@ Castro::cons_to_prim(const Real time)
 
     MultiFab& S_new = get_new_data(State_Type);
 
+    const bool use_thermo = thermo_cache_matches(Sborder);
+
 #ifdef _OPENMP
 #pragma omp parallel
 #endif
@@ -53,7 +55,8 @@ Castro::cons_to_prim(const Real time)
                 lamborder_arr,
 #endif
                 q_arr,
-                qaux_arr);
+                qaux_arr,
+                use_thermo ? thermo_cache.const_array(mfi) : Array4<Real const>{});
 
     }
 
@@ -85,6 +88,8 @@ Castro::cons_to_prim(MultiFab& u, MultiFab& q_in, MultiFab& qaux_in, Real time)
     }
 #endif
 
+    const bool use_thermo = thermo_cache_matches(u);
+
 #ifdef _OPENMP
 #pragma omp parallel
 #endif
@@ -108,7 +113,8 @@ Castro::cons_to_prim(MultiFab& u, MultiFab& q_in, MultiFab& qaux_in, Real time)
                 lamborder_arr,
 #endif
                 q_in_arr,
-                qaux_in_arr);
+                qaux_in_arr,
+                use_thermo ? thermo_cache.const_array(mfi) : Array4<Real const>{});
 
     }
 
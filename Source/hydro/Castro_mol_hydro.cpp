@@ -8,6 +8,7 @@
 #include <advection_util.H>
 
 #include <fourth_center_average.H>
+#include <low_storage_rk.H>
 
 using namespace amrex;
 
@@ -31,7 +32,11 @@ Castro::construct_mol_hydro_source(Real time, Real dt, MultiFab& A_update)
   const Real strt_time = ParallelDescriptor::second();
 
   if (verbose && ParallelDescriptor::IOProcessor()) {
-    std::cout << "... construct advection term, SDC iteration: " << sdc_iteration << "; current node: " << current_sdc_node << std::endl;
+    if (time_integration_method == LowStorageRungeKutta) {
+      std::cout << "... construct advection term, Runge-Kutta stage: " << current_lsrk_stage << std::endl;
+    } else {
+      std::cout << "... construct advection term, SDC iteration: " << sdc_iteration << "; current node: " << current_sdc_node << std::endl;
+    }
   }
 
 
@@ -82,13 +87,40 @@ Castro::construct_mol_hydro_source(Real time, Real dt, MultiFab& A_update)
 
     MultiFab& old_source = get_old_data(Source_Type);
 
-    // The fourth order stuff cannot do tiling because of the Laplacian corrections
-    for (MFIter mfi(S_new, (sdc_order == 4) ? no_tile_size : hydro_tile_size); mfi.isValid(); ++mfi)
+    for (MFIter mfi(S_new, hydro_tile_size); mfi.isValid(); ++mfi)
       {
         const Box& bx  = mfi.tilebox();
 
         const Box& obx = amrex::grow(bx, 1);
-        const Box& obx2 = amrex::grow(bx, 2);
+
+        // The region over which we need the interface states.  For
+        // the fourth order method, the transverse Laplacians that
+        // convert between face averages and face centers use
+        // one-sided stencils reaching 3 zones into the domain at a
+        // physical boundary, so where the tile touches one we extend
+        // this region (and everything built on it) inward by enough
+        // to cover them, however narrow the tile is.  Only the fluxes
+        // on the faces of the tile itself are kept.
+
+        Box sbx = obx;
+
+#ifndef AMREX_USE_GPU
+        if (sdc_order == 4) {
+          const Box& domain = geom.Domain();
+
+          for (int d = 0; d < AMREX_SPACEDIM; ++d) {
+            if (geom.isPeriodic(d)) {
+              continue;
+            }
+            if (bx.smallEnd(d) == domain.smallEnd(d)) {
+              sbx.setBig(d, amrex::max(sbx.bigEnd(d), domain.smallEnd(d) + 3));
+            }
+            if (bx.bigEnd(d) == domain.bigEnd(d)) {
+              sbx.setSmall(d, amrex::min(sbx.smallEnd(d), domain.bigEnd(d) - 3));
+            }
+          }
+        }
+#endif
 
         FArrayBox &statein  = Sborder[mfi];
         Array4<Real const> const uin_arr = statein.array();
@@ -106,25 +138,27 @@ Castro::construct_mol_hydro_source(Real time, Real dt, MultiFab& A_update)
 
         if (time_integration_method == SpectralDeferredCorrections) {
           stage_weight = node_weights[current_sdc_node];
+        } else if (time_integration_method == LowStorageRungeKutta) {
+          stage_weight = low_storage_rk::weight(low_storage_rk::method(lsrk_order), current_lsrk_stage);
         }
 
         // get the flattening coefficient
-        flatn.resize(obx, 1);
+        flatn.resize(sbx, 1);
         Elixir elix_flatn = flatn.elixir();
 
         Array4<Real const> const q_arr = q.array(mfi);
         Array4<Real> const flatn_arr = flatn.array();
 
         if (first_order_hydro == 1) {
-          amrex::ParallelFor(obx,
+          amrex::ParallelFor(sbx,
           [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
           {
             flatn_arr(i,j,k) = 0.0;
           });
         } else if (use_flattening == 1) {
-          uflatten(obx, q_arr, flatn_arr, QPRES);
+          uflatten(sbx, q_arr, flatn_arr, QPRES);
         } else {
-          amrex::ParallelFor(obx,
+          amrex::ParallelFor(sbx,
           [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
           {
             flatn_arr(i,j,k) = 1.0;
@@ -133,7 +167,7 @@ Castro::construct_mol_hydro_source(Real time, Real dt, MultiFab& A_update)
 
         // get the interface states and shock variable
 
-        shk.resize(obx, 1);
+        shk.resize(sbx, 1);
         Elixir elix_shk = shk.elixir();
 
         Array4<Real> const shk_arr = shk.array();
@@ -148,10 +182,10 @@ Castro::construct_mol_hydro_source(Real time, Real dt, MultiFab& A_update)
 #endif
 
         if (hybrid_riemann == 1 || compute_shock) {
-          shock(obx, q_arr, shk_arr);
+          shock(sbx, q_arr, shk_arr);
         }
         else {
-          amrex::ParallelFor(obx,
+          amrex::ParallelFor(sbx,
           [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
           {
             shk_arr(i,j,k) = 0.0;
@@ -204,24 +238,31 @@ Castro::construct_mol_hydro_source(Real time, Real dt, MultiFab& A_update)
           // fourth order method
           // -----------------------------------------------------------------
 
+          // the faces of the tile in each direction, extended
+          // transversely over sbx for the transverse Laplacians
+
           Box ibx[AMREX_SPACEDIM];
-          ibx[0] = amrex::grow(amrex::surroundingNodes(bx, 0), IntVect(AMREX_D_DECL(0,1,1)));
-#if AMREX_SPACEDIM >= 2
-          ibx[1] = amrex::grow(amrex::surroundingNodes(bx, 1), IntVect(AMREX_D_DECL(1,0,1)));
-#endif
-#if AMREX_SPACEDIM == 3
-          ibx[2] = amrex::grow(amrex::surroundingNodes(bx, 2), IntVect(AMREX_D_DECL(1,1,0)));
-#endif
+          for (int idir = 0; idir < AMREX_SPACEDIM; ++idir) {
+            ibx[idir] = amrex::surroundingNodes(bx, idir);
+            for (int d = 0; d < AMREX_SPACEDIM; ++d) {
+              if (d != idir) {
+                ibx[idir].setRange(d, sbx.smallEnd(d), sbx.length(d));
+              }
+            }
+          }
+
+          const Box& sbx1 = amrex::grow(sbx, 1);
+
           for (int idir = 0; idir < AMREX_SPACEDIM; ++idir) {
 
             const Box& nbx = amrex::surroundingNodes(bx, idir);
-            const Box& nbx1 = amrex::grow(nbx, 1);
+            const Box& nbx1 = amrex::surroundingNodes(sbx, idir);
 
-            qm.resize(obx2, NQ);
+            qm.resize(sbx1, NQ);
             Elixir elix_qm = qm.elixir();
             auto qm_arr = qm.array();
 
-            qp.resize(obx2, NQ);
+            qp.resize(sbx1, NQ);
             Elixir elix_qp = qp.elixir();
             auto qp_arr = qp.array();
 
@@ -252,8 +293,8 @@ Castro::construct_mol_hydro_source(Real time, Real dt, MultiFab& A_update)
                                 q_arr, q_int_arr);
 
               // compute the limited interface states
-              // operate on obx -- this loop is over cell-centers
-              states(obx,
+              // operate on sbx -- this loop is over cell-centers
+              states(sbx,
                      idir, n,
                      q_arr, q_int_arr, flatn_arr,
                      qm_arr, qp_arr);
@@ -711,9 +752,10 @@ Castro::construct_mol_hydro_source(Real time, Real dt, MultiFab& A_update)
 
         // For SDC, we store node 0 the only time we enter here (the
         // first iteration) and we store the other nodes only on the
-        // last iteration.
-        if (time_integration_method == SpectralDeferredCorrections &&
-             (current_sdc_node == 0 || sdc_iteration == sdc_order+sdc_extra-1)) {
+        // last iteration.  The Runge-Kutta stages are each visited once.
+        if ((time_integration_method == SpectralDeferredCorrections &&
+             (current_sdc_node == 0 || sdc_iteration == sdc_order+sdc_extra-1)) ||
+            time_integration_method == LowStorageRungeKutta) {
 
           for (int idir = 0; idir < AMREX_SPACEDIM; ++idir) {
 
@@ -36,10 +36,13 @@ Castro::ctoprim(const Box& bx,
                 Array4<Real const> const& lam,
 #endif
                 Array4<Real> const& q_arr,
-                Array4<Real> const& qaux_arr) {
+                Array4<Real> const& qaux_arr,
+                Array4<Real const> const& thermo) {
 
   amrex::ignore_unused(time);
 
+  const Real thermo_rtol = castro::thermo_cache_rtol;
+
   amrex::ParallelFor(bx,
   [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
   {
@@ -53,7 +56,8 @@ Castro::ctoprim(const Box& bx,
 #ifdef RADIATION
                                        Erin, lam,
 #endif
-                                       q, qaux, q_arr.nComp() == NQ);
+                                       q, qaux, q_arr.nComp() == NQ,
+                                       thermo, thermo_rtol);
   });
 }
 
@@ -477,6 +481,47 @@ Castro::normalize_species_fluxes(const Box& bx,
 }
 
 
+bool
+Castro::composition_is_uniform(const Box& bx,
+                               Array4<Real const> const& U_arr,
+                               Array4<Real const> const& rho_inv_arr) {
+
+  if (NumSpec + NumAux == 0) {
+      return true;
+  }
+
+  // Compare every zone against the composition of the lower corner
+  // of the box, and find the largest deviation in any component.
+
+  const auto lo = amrex::lbound(bx);
+
+  ReduceOps<ReduceOpMax> reduce_op;
+  ReduceData<Real> reduce_data(reduce_op);
+  using ReduceTuple = typename decltype(reduce_data)::Type;
+
+  reduce_op.eval(bx, reduce_data,
+  [=] AMREX_GPU_HOST_DEVICE (int i, int j, int k) -> ReduceTuple
+  {
+      Real dX_max = 0.0_rt;
+
+      for (int n = 0; n < NumSpec + NumAux; ++n) {
+          const int nc = n < NumSpec ? UFS + n : UFX + n - NumSpec;
+
+          Real X = U_arr(i,j,k,nc) * rho_inv_arr(i,j,k);
+          Real X_ref = U_arr(lo.x,lo.y,lo.z,nc) * rho_inv_arr(lo.x,lo.y,lo.z);
+
+          dX_max = amrex::max(dX_max, std::abs(X - X_ref));
+      }
+
+      return {dX_max};
+  });
+
+  ReduceTuple hv = reduce_data.value();
+
+  return amrex::get<0>(hv) <= uniform_composition_tol;
+}
+
+
 void  // NOLINTNEXTLINE(readability-convert-member-functions-to-static)
 Castro::scale_flux(const Box& bx,
 #if AMREX_SPACEDIM == 1
@@ -1,6 +1,7 @@
 #include <Castro.H>
 
 #include <riemann_solvers.H>
+#include <riemann_batch.H>
 
 #ifdef RADIATION
 #include <Radiation.H>
@@ -65,6 +66,81 @@ Castro::cmpflx_plus_godunov(const Box& bx,
     const auto domlo = geom.Domain().loVect3d();
     const auto domhi = geom.Domain().hiVect3d();
 
+#if !defined(AMREX_USE_GPU) && !defined(RADIATION)
+    if (riemann_batch == 1 &&
+        (riemann_solver == 0 || riemann_solver == 1) && ppm_temp_fix != 2) {
+
+        // solve the Riemann problems on a pencil of interfaces at a
+        // time, with the states stored as structure-of-arrays so the
+        // two-shock solvers vectorize
+
+        const auto lo = amrex::lbound(bx);
+        const auto hi = amrex::ubound(bx);
+
+        RiemannStateBatch ql_b;
+        RiemannStateBatch qr_b;
+        RiemannAuxBatch raux_b;
+        RiemannStateBatch qint_b;
+
+        for (int k = lo.z; k <= hi.z; ++k) {
+            for (int j = lo.y; j <= hi.y; ++j) {
+                for (int i0 = lo.x; i0 <= hi.x; i0 += RIEMANN_BATCH_SIZE) {
+
+                    const int nb = amrex::min(RIEMANN_BATCH_SIZE, hi.x - i0 + 1);
+
+                    for (int m = 0; m < nb; ++m) {
+                        const int i = i0 + m;
+
+                        RiemannState ql;
+                        RiemannState qr;
+                        RiemannAux raux;
+
+                        load_input_states(i, j, k, idir,
+                                          qm, qp, qaux_arr,
+                                          ql, qr, raux);
+
+                        raux.bnd_fac = riemann_bnd_fac(i, j, k, idir,
+                                                       special_bnd_lo, special_bnd_hi,
+                                                       domlo, domhi);
+
+                        ql_b.set(m, ql);
+                        qr_b.set(m, qr);
+                        raux_b.set(m, raux);
+                    }
+
+                    if (riemann_solver == 0) {
+                        riemannus_batch(nb, ql_b, qr_b, raux_b, qint_b);
+                    } else {
+                        riemanncg_batch(nb, ql_b, qr_b, raux_b, qint_b);
+                    }
+
+                    for (int m = 0; m < nb; ++m) {
+                        const int i = i0 + m;
+
+                        RiemannState qint = qint_b.get(m);
+
+                        compute_flux_q(i, j, k, idir,
+                                       geomdata,
+                                       qint, flx,
+                                       qgdnv, store_full_state);
+
+                        upwind_passive_fluxes(i, j, k, qint.un,
+                                              qm, qp, flx,
+                                              qgdnv, store_full_state);
+
+                        if (hybrid_riemann == 1) {
+                            hybrid_hll_flux(i, j, k, idir, coord,
+                                            qm, qp, qaux_arr, shk, flx);
+                        }
+                    }
+                }
+            }
+        }
+
+        return;
+    }
+#endif
+
     amrex::ParallelFor(bx,
     [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
     {
@@ -98,26 +174,9 @@ Castro::cmpflx_plus_godunov(const Box& bx,
             // the passives are always just upwinded, so we do that here
             // regardless of the solver
 
-            Real sgnm = std::copysign(1.0_rt, qint.un);
-            if (qint.un == 0.0_rt) {
-                sgnm = 0.0_rt;
-            }
-
-            Real fp = 0.5_rt*(1.0_rt + sgnm);
-            Real fm = 0.5_rt*(1.0_rt - sgnm);
-
-            for (int ipassive = 0; ipassive < npassive; ipassive++) {
-                int nqp = qpassmap(ipassive);
-                int n  = upassmap(ipassive);
-
-                Real X_int = fp * qm(i,j,k,nqp) + fm * qp(i,j,k,nqp);
-
-                flx(i,j,k,n) = flx(i,j,k,URHO) * X_int;
-
-                if (store_full_state) {
-                    qgdnv(i,j,k,nqp) = X_int;
-                }
-            }
+            upwind_passive_fluxes(i, j, k, qint.un,
+                                  qm, qp, flx,
+                                  qgdnv, store_full_state);
 
         } else if (riemann_solver == 2) {
             // HLLC
@@ -139,56 +198,8 @@ Castro::cmpflx_plus_godunov(const Box& bx,
         if (hybrid_riemann == 1) {
             // correct the fluxes using an HLL scheme if we are in a shock
             // and doing the hybrid approach
-
-            int is_shock = 0;
-
-            if (idir == 0) {
-                is_shock = static_cast<int>(shk(i-1,j,k) + shk(i,j,k));
-            } else if (idir == 1) { 
-                is_shock = static_cast<int>(shk(i,j-1,k) + shk(i,j,k));
-            } else {
-                is_shock = static_cast<int>(shk(i,j,k-1) + shk(i,j,k));
-            }
-
-            if (is_shock >= 1) {
-
-                Real cl;
-                Real cr;
-                if (idir == 0) {
-                    cl = qaux_arr(i-1,j,k,QC);
-                    cr = qaux_arr(i,j,k,QC);
-                } else if (idir == 1) { 
-                    cl = qaux_arr(i,j-1,k,QC);
-                    cr = qaux_arr(i,j,k,QC);
-                } else {
-                    cl = qaux_arr(i,j,k-1,QC);
-                    cr = qaux_arr(i,j,k,QC);
-                }
-
-                Real ql_zone[NQ];
-                Real qr_zone[NQ];
-                Real flx_zone[NUM_STATE];
-
-                for (int n = 0; n < NQ; n++) {
-                    ql_zone[n] = qm(i,j,k,n);
-                    qr_zone[n] = qp(i,j,k,n);
-                }
-
-                // pass in the current flux -- the
-                // HLL solver will overwrite this
-                // if necessary
-                for (int n = 0; n < NUM_STATE; n++) {
-                    flx_zone[n] = flx(i,j,k,n);
-                }
-
-                HLL(ql_zone, qr_zone, cl, cr,
-                    idir, coord,
-                    flx_zone);
-
-                for (int n = 0; n < NUM_STATE; n++) {
-                    flx(i,j,k,n) = flx_zone[n];
-                }
-            }
+            hybrid_hll_flux(i, j, k, idir, coord,
+                            qm, qp, qaux_arr, shk, flx);
         }
     });
 
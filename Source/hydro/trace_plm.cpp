@@ -27,6 +27,7 @@ Castro::trace_plm(const Box& bx, const int idir,
 #endif
                   Array4<Real const> const& srcQ,
                   const Box& vbx,
+                  const bool uniform_composition,
                   const Real dt) {
 
   // here, bx is the box we loop over -- this can include ghost cells
@@ -332,8 +333,16 @@ Castro::trace_plm(const Box& bx, const int idir,
 
       // get the slope
 
-      load_passive_stencil(U_arr, rho_inv_arr, idir, i, j, k, nc, s);
-      Real dX = uslope(s, flat, false, false);
+      Real dX = 0.0_rt;
+
+      if (uniform_composition && ipassive >= NumAdv) {
+          // the species and auxiliary quantities are constant over
+          // the stencil, so the slope vanishes
+          s[i0] = U_arr(i,j,k,nc) * rho_inv_arr(i,j,k);
+      } else {
+          load_passive_stencil(U_arr, rho_inv_arr, idir, i, j, k, nc, s);
+          dX = uslope(s, flat, false, false);
+      }
 
       // Right state
       if ((idir == 0 && i >= vlo[0]) ||
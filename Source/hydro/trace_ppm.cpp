@@ -28,6 +28,7 @@ Castro::trace_ppm(const Box& bx,
                   Array4<Real const> const& dloga,
 #endif
                   const Box& vbx,
+                  const bool uniform_composition,
                   const Real dt) {
 
   // here, lo and hi are the range we loop over -- this can include ghost cells
@@ -387,9 +388,16 @@ Castro::trace_ppm(const Box& bx,
         int nc = upassmap(ipassive);
         int n = qpassmap(ipassive);
 
-        load_passive_stencil(U_arr, rho_inv_arr, idir, i, j, k, nc, s);
-        ppm_reconstruct(s, flat, sm, sp);
-        ppm_int_profile_single(sm, sp, s[i0], un, dtdx, Ip_passive, Im_passive);
+        if (uniform_composition && ipassive >= NumAdv) {
+            // the species and auxiliary quantities are constant over
+            // the stencil, so the parabola is just the zone value
+            Ip_passive = U_arr(i,j,k,nc) * rho_inv_arr(i,j,k);
+            Im_passive = Ip_passive;
+        } else {
+            load_passive_stencil(U_arr, rho_inv_arr, idir, i, j, k, nc, s);
+            ppm_reconstruct(s, flat, sm, sp);
+            ppm_int_profile_single(sm, sp, s[i0], un, dtdx, Ip_passive, Im_passive);
+        }
 
         // Plus state on face i
 
@@ -729,9 +729,10 @@ Castro::construct_ctu_mhd_source(Real time, Real dt)
 
     }
 
-    // Check for small/negative densities and X > 1 or X < 0.
+    // Check the validity of the new state (small/negative densities,
+    // X > 1 or X < 0, ...) before clean_state resets it.
 
-    status = check_for_negative_density();
+    status = check_state_validity(false);
 
     if (status.success == false) {
         return status;
@@ -741,9 +742,15 @@ Castro::construct_ctu_mhd_source(Real time, Real dt)
 
     clean_state(Bx_new, By_new, Bz_new, S_new, time + dt, 0);
 
-    // Check for NaN's.
+    // Check for NaNs (which survive clean_state, and which computeTemp
+    // and the energy resets can produce) and the temperature bounds,
+    // now that the temperature is up to date.
 
-    check_for_nan(S_new);
+    status = check_state_validity(true);
+
+    if (status.success == false) {
+        return status;
+    }
 
     // Perform reflux (for non-subcycling advances).
 
@@ -1,6 +1,7 @@
 #include <iomanip>
 #include <vector>
 #include <algorithm>
+#include <memory>
 #include <string>
 #include <Castro.H>
 
@@ -8,11 +9,14 @@
 
 #include <particles_declares.H>
 
+#include <tracer_push.H>
+
 using namespace amrex;
 
 #ifdef AMREX_PARTICLES
 
 AmrTracerParticleContainer* Castro::TracerPC =  0;
+ParticleHistory* Castro::TracerHistory = nullptr;
 
 namespace {
     std::vector<int>  timestamp_indices;
@@ -26,6 +30,19 @@ Castro::read_particle_params ()
 
   ParmParse pp("particles");
 
+    if (particles::integration_order != 2 && particles::integration_order != 4) {
+        amrex::Error("particles.integration_order must be 2 or 4");
+    }
+
+    if (particles::interpolation_type != tracer_interp::cic &&
+        particles::interpolation_type != tracer_interp::tsc) {
+        amrex::Error("particles.interpolation_type must be 0 (CIC) or 1 (TSC)");
+    }
+
+    if (particles::history_interval <= 0 || particles::history_flush_interval <= 0) {
+        amrex::Error("particles.history_interval and particles.history_flush_interval must be positive");
+    }
+
     if (ParallelDescriptor::IOProcessor())
         if (!amrex::UtilCreateDirectory(particles::timestamp_dir, 0755))
             amrex::CreateDirectoryFailed(particles::timestamp_dir);
@@ -55,6 +72,12 @@ Castro::init_particles ()
         {
             TracerPC->InitFromAsciiFile(particles::particle_init_file,0);
         }
+
+        if (! particles::history_dir.empty())
+        {
+            TracerHistory = new ParticleHistory(particles::history_dir,
+                                                particles::history_single_precision);
+        }
     }
 }
 
@@ -65,6 +88,11 @@ Castro::ParticleCheckPoint(const std::string& dir)
     {
         if (TracerPC)
             TracerPC->Checkpoint(dir, chk_tracer_particle_file);
+
+        // make sure the histories up to the checkpoint are on disk,
+        // so nothing is lost if we restart from it
+        if (TracerHistory)
+            TracerHistory->flush(parent->levelSteps(0));
     }
 }
 
@@ -110,6 +138,14 @@ Castro::ParticlePostRestart (const std::string& restart_file)
             {
                 TracerPC->WriteAsciiFile(particles::particle_output_file);
             }
+
+            if (!particles::history_dir.empty())
+            {
+                BL_ASSERT(TracerHistory == nullptr);
+
+                TracerHistory = new ParticleHistory(particles::history_dir,
+                                                    particles::history_single_precision);
+            }
         }
     }
 }
@@ -245,6 +281,25 @@ Castro::TimestampParticles (int ngrow)
     }
 }
 
+void
+Castro::RecordParticleHistory ()
+{
+    if (TracerPC && TracerHistory)
+    {
+        const int nstep = parent->levelSteps(0);
+
+        if (nstep % particles::history_interval == 0)
+        {
+            TracerHistory->sample(*TracerPC, *parent, state[State_Type].curTime(), nstep);
+        }
+
+        if (nstep % particles::history_flush_interval == 0)
+        {
+            TracerHistory->flush(nstep);
+        }
+    }
+}
+
 #endif
 
 void
@@ -252,29 +307,67 @@ Castro::advance_particles(int iteration, Real time, Real dt)
 {
     if (TracerPC)
     {
-        int ng = iteration;
-        Real t = time + 0.5*dt;
+        BL_PROFILE("Castro::advance_particles()");
 
-        MultiFab Ucc(grids,dmap,AMREX_SPACEDIM,ng); // cell centered velocity
+        const bool rk4 = particles::integration_order == 4;
+        const int interp = particles::interpolation_type;
 
-        {
-            FillPatchIterator fpi(*this, Ucc, ng, t, State_Type, 0, AMREX_SPACEDIM+1);
-            MultiFab& S = fpi.get_mf();
+        // Particles on this level can be up to iteration-1 zones
+        // outside the valid region (they are only redistributed at
+        // the end of the coarse step), and the interpolation stencil
+        // reaches one zone further.  The last RK4 stage can be
+        // another zone away.
+
+        const int ng = iteration + (rk4 ? 1 : 0);
+
+        // we interpolate the velocity straight from the density and
+        // momenta, so only those need to be filled
+
+        const int ncomp = UMX - URHO + AMREX_SPACEDIM;
+
+        MultiFab& S_new = get_new_data(State_Type);
+
+        // the midpoint method uses the state at the half time; RK4
+        // interpolates in time between the start and end of the step
+
+        FillPatchIterator fpi_a(*this, S_new, ng, rk4 ? time : time + 0.5_rt * dt,
+                                State_Type, URHO, ncomp);
+
+        std::unique_ptr<FillPatchIterator> fpi_b;
+        if (rk4) {
+            fpi_b = std::make_unique<FillPatchIterator>(*this, S_new, ng, time + dt,
+                                                        State_Type, URHO, ncomp);
+        }
+
+        const MultiFab& Sa = fpi_a.get_mf();
+        const MultiFab& Sb = rk4 ? fpi_b->get_mf() : Sa;
+
+        const auto plo = geom.ProbLoArray();
+        const auto dxi = geom.InvCellSizeArray();
 
 #ifdef _OPENMP
 #pragma omp parallel
 #endif
-            for (MFIter mfi(Ucc,true); mfi.isValid(); ++mfi)
+        for (AmrTracerParticleContainer::ParIterType pti(*TracerPC, level); pti.isValid(); ++pti)
+        {
+            auto& aos = pti.GetArrayOfStructs();
+            const int np = aos.numParticles();
+            auto* const pstruct = aos().dataPtr();
+
+            auto const sa = Sa.const_array(pti);
+            auto const sb = Sb.const_array(pti);
+
+            amrex::ParallelFor(np,
+            [=] AMREX_GPU_HOST_DEVICE (int i) noexcept
             {
-                const Box& bx = mfi.growntilebox();
-                S[mfi].invert(1.0, bx, 0, 1);
-                for (int dir=0; dir < AMREX_SPACEDIM; ++dir) {
-                    Ucc[mfi].copy(S[mfi], bx, dir+1, bx, dir, 1);
-                    Ucc[mfi].mult(S[mfi], bx, 0, dir);
+                auto& p = pstruct[i];
+
+                if (p.id() <= 0) {
+                    return;
                 }
-            }
-        }
 
-        TracerPC->AdvectWithUcc(Ucc, level, dt);
+                tracer_push(p, plo, dxi, sa, sb, dt, rk4, interp);
+            });
+        }
     }
 }
@@ -0,0 +1,234 @@
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+
+#include <AMReX_Utility.H>
+
+#include <Castro.H>
+#include <network.H>
+
+#include <particle_history.H>
+
+using namespace amrex;
+
+namespace {
+
+    template <typename T>
+    void write_value (std::ofstream& os, const T val)
+    {
+        os.write(reinterpret_cast<const char*>(&val), sizeof(T));
+    }
+
+    // write a floating point value at the precision of the file
+    void write_real (std::ofstream& os, const Real val, const bool single_precision)
+    {
+        if (single_precision) {
+            write_value(os, static_cast<float>(val));
+        } else {
+            write_value(os, static_cast<double>(val));
+        }
+    }
+
+}
+
+ParticleHistory::ParticleHistory (const std::string& dir_, bool single_precision_)
+    : dir(dir_), single_precision(single_precision_)
+{
+    if (ParallelDescriptor::IOProcessor()) {
+        if (!amrex::UtilCreateDirectory(dir, 0755)) {
+            amrex::CreateDirectoryFailed(dir);
+        }
+    }
+    ParallelDescriptor::Barrier();
+}
+
+ParticleHistory::~ParticleHistory ()
+{
+    flush(last_nstep);
+}
+
+void
+ParticleHistory::sample (AmrTracerParticleContainer& pc, Amr& amr, Real time, int nstep)
+{
+    BL_PROFILE("ParticleHistory::sample()");
+
+    last_nstep = nstep;
+
+    for (int lev = 0; lev <= amr.finestLevel(); ++lev) {
+
+        if (pc.NumberOfParticlesAtLevel(lev, true, true) <= 0) {
+            continue;
+        }
+
+        const MultiFab& S = amr.getLevel(lev).get_new_data(State_Type);
+#ifdef REACTIONS
+        const MultiFab& R = amr.getLevel(lev).get_new_data(Reactions_Type);
+#endif
+
+        const auto plo = amr.Geom(lev).ProbLoArray();
+        const auto dxi = amr.Geom(lev).InvCellSizeArray();
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        for (AmrTracerParticleContainer::ParIterType pti(pc, lev); pti.isValid(); ++pti)
+        {
+            auto& aos = pti.GetArrayOfStructs();
+            const int np = aos.numParticles();
+
+            if (np == 0) {
+                continue;
+            }
+
+            const auto* const pstruct = aos().dataPtr();
+
+            const auto vlo = amrex::lbound(pti.validbox());
+            const auto vhi = amrex::ubound(pti.validbox());
+
+            auto const s = S.const_array(pti);
+#ifdef REACTIONS
+            auto const r = R.const_array(pti);
+#endif
+
+            Gpu::DeviceVector<Record> rec_d(np);
+            Record* const rec = rec_d.dataPtr();
+
+            amrex::ParallelFor(np,
+            [=] AMREX_GPU_HOST_DEVICE (int n) noexcept
+            {
+                const auto& p = pstruct[n];
+                Record& h = rec[n];
+
+                h.id = p.id();
+                h.cpu = p.cpu();
+                h.time = time;
+
+                // the zone holding the particle (kept inside the box,
+                // in case a particle sits exactly on its upper edge)
+
+                int idx[3] = {0, 0, 0};
+                const int lo[3] = {vlo.x, vlo.y, vlo.z};
+                const int hi[3] = {vhi.x, vhi.y, vhi.z};
+
+                for (int d = 0; d < AMREX_SPACEDIM; ++d) {
+                    h.pos[d] = p.pos(d);
+                    idx[d] = static_cast<int>(std::floor((p.pos(d) - plo[d]) * dxi[d]));
+                    idx[d] = amrex::min(amrex::max(idx[d], lo[d]), hi[d]);
+                }
+
+                const int i = idx[0];
+                const int j = idx[1];
+                const int k = idx[2];
+
+                const Real rhoinv = 1.0_rt / s(i,j,k,URHO);
+
+                h.rho = s(i,j,k,URHO);
+                h.T = s(i,j,k,UTEMP);
+
+                Real ye = 0.0_rt;
+                for (int ns = 0; ns < NumSpec; ++ns) {
+                    ye += s(i,j,k,UFS+ns) * rhoinv * zion[ns] / aion[ns];
+                }
+                h.Ye = ye;
+
+#ifdef REACTIONS
+                h.enuc = r(i,j,k,0) * rhoinv;
+#else
+                h.enuc = 0.0_rt;
+#endif
+            });
+
+            Vector<Record> rec_h(np);
+            Gpu::copyAsync(Gpu::deviceToHost, rec_d.begin(), rec_d.end(), rec_h.begin());
+            Gpu::streamSynchronize();
+
+#ifdef _OPENMP
+#pragma omp critical (particle_history_sample)
+#endif
+            {
+                for (const auto& h : rec_h) {
+                    if (h.id > 0) {
+                        buffer.push_back(h);
+                    }
+                }
+            }
+        }
+    }
+}
+
+void
+ParticleHistory::flush (int nstep)
+{
+    BL_PROFILE("ParticleHistory::flush()");
+
+    if (buffer.empty()) {
+        return;
+    }
+
+    // the samples were appended in time order, so a stable sort by
+    // particle keeps each particle's history in time order
+
+    std::stable_sort(buffer.begin(), buffer.end(),
+                     [] (const Record& a, const Record& b)
+                     {
+                         return (a.id < b.id) || (a.id == b.id && a.cpu < b.cpu);
+                     });
+
+    // the index: where each particle's history starts, and how long it is
+
+    Vector<std::int64_t> first;
+    for (std::int64_t n = 0; n < static_cast<std::int64_t>(buffer.size()); ++n) {
+        if (n == 0 || buffer[n].id != buffer[n-1].id || buffer[n].cpu != buffer[n-1].cpu) {
+            first.push_back(n);
+        }
+    }
+    const int nparticles = first.size();
+    first.push_back(buffer.size());
+
+    std::string filename = dir;
+    if (filename.back() != '/') {
+        filename += '/';
+    }
+    filename += amrex::Concatenate("hist_", nstep, 7);
+    filename += amrex::Concatenate("_", ParallelDescriptor::MyProc(), 5);
+
+    std::ofstream os(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!os.good()) {
+        amrex::FileOpenFailed(filename);
+    }
+
+    // header
+
+    const std::int32_t version = 1;
+    const std::int32_t real_size = single_precision ? sizeof(float) : sizeof(double);
+
+    write_value(os, version);
+    write_value(os, static_cast<std::int32_t>(AMREX_SPACEDIM));
+    write_value(os, real_size);
+    write_value(os, static_cast<std::int32_t>(nparticles));
+    write_value(os, static_cast<std::int64_t>(buffer.size()));
+
+    for (int ip = 0; ip < nparticles; ++ip) {
+        write_value(os, static_cast<std::int32_t>(buffer[first[ip]].id));
+        write_value(os, static_cast<std::int32_t>(buffer[first[ip]].cpu));
+        write_value(os, first[ip]);
+        write_value(os, first[ip+1] - first[ip]);
+    }
+
+    // the samples; the time is always in double precision
+
+    for (const auto& h : buffer) {
+        write_value(os, static_cast<double>(h.time));
+        for (int d = 0; d < AMREX_SPACEDIM; ++d) {
+            write_real(os, h.pos[d], single_precision);
+        }
+        write_real(os, h.rho, single_precision);
+        write_real(os, h.T, single_precision);
+        write_real(os, h.Ye, single_precision);
+        write_real(os, h.enuc, single_precision);
+    }
+
+    os.close();
+
+    buffer.clear();
+}
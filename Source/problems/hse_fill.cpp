@@ -3,8 +3,177 @@
 #include <runtime_parameters.H>
 #include <ext_bc_types.H>
 
+#include <array>
+#include <map>
+
 using namespace amrex;
 
+// The HSE ghost cell columns only depend on the interior state right
+// next to the boundary (and the temperature one zone further in, if we
+// are interpolating it), so with castro.hse_cache = 1 we keep the
+// integrated columns for each box we fill and reuse a column when that
+// state has not changed.  Each destination box gets its own entry, so
+// fills of different boxes never touch the same data.  Entries that
+// were not used during the last coarse timestep are dropped, so the
+// cache only holds the boxes that are still being filled.
+
+namespace {
+
+    // the key is the interior density, temperature, next-interior
+    // temperature, and mass fractions (and auxiliary quantities)
+    constexpr int HSE_NKEY = 3 + NumSpec + NumAux;
+
+    // the cached values are the density and specific internal energy
+    constexpr int HSE_NVAL = 2;
+
+    struct HSEFillCacheEntry {
+        FArrayBox key;
+        FArrayBox val;
+        int last_used{0};
+    };
+
+    // domain (identifying the level), direction, side, column box, and
+    // the box of the data being filled
+    using HSEFillCacheIndex = std::array<int, 6 * AMREX_SPACEDIM + 2>;
+
+    std::map<HSEFillCacheIndex, HSEFillCacheEntry> hse_fill_cache;
+
+    // counts the calls to prune_hse_fill_cache()
+    int hse_fill_cache_step = 0;
+
+    void
+    hse_fill_cache_arrays (const Geometry& geom, const Box& gbx, const Box& adv_bx,
+                           const int dir, const int side,
+                           Array4<Real>& key, Array4<Real>& val)
+    {
+        HSEFillCacheIndex index;
+        int m = 0;
+        for (const Box& b : {geom.Domain(), gbx, adv_bx}) {
+            for (int d = 0; d < AMREX_SPACEDIM; ++d) {
+                index[m++] = b.smallEnd(d);
+                index[m++] = b.bigEnd(d);
+            }
+        }
+        index[m++] = dir;
+        index[m++] = side;
+
+        // the cached values cover the ghost cells from the column box
+        // out to the edge of the data
+
+        Box val_bx(gbx);
+        if (side == 0) {
+            val_bx.setSmall(dir, adv_bx.smallEnd(dir));
+        } else {
+            val_bx.setBig(dir, adv_bx.bigEnd(dir));
+        }
+
+        HSEFillCacheEntry* entry;
+
+#ifdef _OPENMP
+#pragma omp critical (hse_fill_cache)
+#endif
+        {
+            auto it = hse_fill_cache.find(index);
+            if (it == hse_fill_cache.end()) {
+                entry = &hse_fill_cache[index];
+                entry->key.resize(gbx, HSE_NKEY);
+                entry->val.resize(val_bx, HSE_NVAL);
+
+                // a negative density marks a column that has not been filled yet
+                entry->key.setVal<RunOn::Device>(-1.0_rt);
+            } else {
+                entry = &(it->second);
+            }
+            entry->last_used = hse_fill_cache_step;
+        }
+
+        key = entry->key.array();
+        val = entry->val.array();
+    }
+
+    AMREX_GPU_HOST_DEVICE AMREX_INLINE
+    bool
+    hse_column_cached (Array4<Real const> const& key, const int i, const int j, const int k,
+                       Array4<Real const> const& adv,
+                       const int ib, const int jb, const int kb,
+                       const int in, const int jn, const int kn,
+                       const Real tol)
+    {
+        Real dens = adv(ib,jb,kb,URHO);
+
+        if (key(i,j,k,0) <= 0.0_rt) {
+            return false;
+        }
+
+        if (std::abs(dens - key(i,j,k,0)) > tol * key(i,j,k,0) ||
+            std::abs(adv(ib,jb,kb,UTEMP) - key(i,j,k,1)) > tol * key(i,j,k,1) ||
+            std::abs(adv(in,jn,kn,UTEMP) - key(i,j,k,2)) > tol * std::abs(key(i,j,k,2))) {
+            return false;
+        }
+
+        for (int n = 0; n < NumSpec; n++) {
+            if (std::abs(adv(ib,jb,kb,UFS+n) / dens - key(i,j,k,3+n)) > tol) {
+                return false;
+            }
+        }
+#if NAUX_NET > 0
+        for (int n = 0; n < NumAux; n++) {
+            if (std::abs(adv(ib,jb,kb,UFX+n) / dens - key(i,j,k,3+NumSpec+n)) > tol) {
+                return false;
+            }
+        }
+#endif
+
+        return true;
+    }
+
+    AMREX_GPU_HOST_DEVICE AMREX_INLINE
+    void
+    hse_store_column_key (Array4<Real> const& key, const int i, const int j, const int k,
+                          Array4<Real const> const& adv,
+                          const int ib, const int jb, const int kb,
+                          const int in, const int jn, const int kn)
+    {
+        Real dens = adv(ib,jb,kb,URHO);
+
+        key(i,j,k,1) = adv(ib,jb,kb,UTEMP);
+        key(i,j,k,2) = adv(in,jn,kn,UTEMP);
+        for (int n = 0; n < NumSpec; n++) {
+            key(i,j,k,3+n) = adv(ib,jb,kb,UFS+n) / dens;
+        }
+#if NAUX_NET > 0
+        for (int n = 0; n < NumAux; n++) {
+            key(i,j,k,3+NumSpec+n) = adv(ib,jb,kb,UFX+n) / dens;
+        }
+#endif
+
+        // the density goes last, since it marks the column as valid
+        key(i,j,k,0) = dens;
+    }
+
+}
+
+
+void
+clear_hse_fill_cache ()
+{
+    hse_fill_cache.clear();
+}
+
+void
+prune_hse_fill_cache ()
+{
+    for (auto it = hse_fill_cache.begin(); it != hse_fill_cache.end(); ) {
+        if (it->second.last_used < hse_fill_cache_step) {
+            it = hse_fill_cache.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    ++hse_fill_cache_step;
+}
+
 
 // a hydrostatic boundary conditions -- this relies on the assumption
 // that the gravitation acceleration is constant
@@ -47,6 +216,17 @@ hse_fill(const Box& bx, Array4<Real> const& adv,
             Box gbx(IntVect(D_DECL(domlo[0]-1, lo[1], lo[2])),
                     IntVect(D_DECL(domlo[0]-1, hi[1], hi[2])));
 
+            // the cached columns from the last fill of this box, if any
+
+            const bool use_cache = hse_cache == 1;
+            const Real cache_tol = hse_cache_tol;
+
+            Array4<Real> cache_key;
+            Array4<Real> cache_val;
+            if (use_cache) {
+                hse_fill_cache_arrays(geom, gbx, adv_bx, 0, 0, cache_key, cache_val);
+            }
+
             amrex::ParallelFor(gbx,
             [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
             {
@@ -88,6 +268,12 @@ hse_fill(const Box& bx, Array4<Real> const& adv,
 
                 Real pres_above = eos_state.p;
 
+                // if the interior state next to the boundary is (nearly)
+                // what it was at the last fill of this box, reuse that column
+
+                const bool cached = use_cache &&
+                    hse_column_cached(cache_key, i, j, k, adv, domlo[0],j,k, domlo[0]+1,j,k, cache_tol);
+
                 for (int ii = domlo[0]-1; ii >= adv_lo[0]; ii--) {
 
                     // we are integrating along a column at constant i.
@@ -97,7 +283,7 @@ hse_fill(const Box& bx, Array4<Real> const& adv,
 
                     // initial guesses
 
-                    Real dens_zone = dens_above;
+                    Real dens_zone = cached ? cache_val(ii,j,k,0) : dens_above;
 
                     // temperature and species held constant in BCs
 
@@ -112,12 +298,12 @@ hse_fill(const Box& bx, Array4<Real> const& adv,
                         }
                     }
 
-                    [[maybe_unused]] bool converged_hse = false;
+                    [[maybe_unused]] bool converged_hse = cached;
 
                     Real p_want;
                     Real drho;
 
-                    for (int iter = 0; iter < hse::MAX_ITER; iter++) {
+                    for (int iter = 0; iter < hse::MAX_ITER && !cached; iter++) {
 
                         // pressure needed from HSE
 
@@ -195,13 +381,28 @@ hse_fill(const Box& bx, Array4<Real> const& adv,
                       }
                    }
 
-                   eos_state.rho = dens_zone;
-                   eos_state.T = temp_zone;
+                   Real pres_zone;
+                   Real eint;
+
+                   if (cached) {
+                       // the pressure is only needed by the HSE integration,
+                       // which we skip for the whole column
+                       pres_zone = 0.0_rt;
+                       eint = cache_val(ii,j,k,1);
+                   } else {
+                       eos_state.rho = dens_zone;
+                       eos_state.T = temp_zone;
+
+                       eos(eos_input_rt, eos_state);
 
-                   eos(eos_input_rt, eos_state);
+                       pres_zone = eos_state.p;
+                       eint = eos_state.e;
 
-                   Real pres_zone = eos_state.p;
-                   Real eint = eos_state.e;
+                       if (use_cache) {
+                           cache_val(ii,j,k,0) = dens_zone;
+                           cache_val(ii,j,k,1) = eint;
+                       }
+                   }
 
                    // store the final state
 
@@ -227,6 +428,10 @@ hse_fill(const Box& bx, Array4<Real> const& adv,
                    pres_above = pres_zone;
 
                 }
+
+                if (use_cache && !cached) {
+                    hse_store_column_key(cache_key, i, j, k, adv, domlo[0],j,k, domlo[0]+1,j,k);
+                }
             });
 
         }
@@ -243,6 +448,17 @@ hse_fill(const Box& bx, Array4<Real> const& adv,
             Box gbx(IntVect(D_DECL(domhi[0]+1, lo[1], lo[2])),
                     IntVect(D_DECL(domhi[0]+1, hi[1], hi[2])));
 
+            // the cached columns from the last fill of this box, if any
+
+            const bool use_cache = hse_cache == 1;
+            const Real cache_tol = hse_cache_tol;
+
+            Array4<Real> cache_key;
+            Array4<Real> cache_val;
+            if (use_cache) {
+                hse_fill_cache_arrays(geom, gbx, adv_bx, 0, 1, cache_key, cache_val);
+            }
+
             amrex::ParallelFor(gbx,
             [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
             {
@@ -284,12 +500,18 @@ hse_fill(const Box& bx, Array4<Real> const& adv,
 
                 Real pres_below = eos_state.p;
 
+                // if the interior state next to the boundary is (nearly)
+                // what it was at the last fill of this box, reuse that column
+
+                const bool cached = use_cache &&
+                    hse_column_cached(cache_key, i, j, k, adv, domhi[0],j,k, domhi[0]-1,j,k, cache_tol);
+
                 for (int ii = domhi[0]+1; ii <= adv_hi[0]; ii++) {
 
                     // HSE integration to get density, pressure
 
                     // initial guesses
-                    Real dens_zone = dens_below;
+                    Real dens_zone = cached ? cache_val(ii,j,k,0) : dens_below;
 
                     // temperature and species held constant in BCs
 
@@ -304,12 +526,12 @@ hse_fill(const Box& bx, Array4<Real> const& adv,
                         }
                     }
 
-                    [[maybe_unused]] bool converged_hse = false;
+                    [[maybe_unused]] bool converged_hse = cached;
 
                     Real p_want;
                     Real drho;
 
-                    for (int iter = 0; iter < hse::MAX_ITER; iter++) {
+                    for (int iter = 0; iter < hse::MAX_ITER && !cached; iter++) {
 
                         // pressure needed from HSE
                         p_want = pres_below +
@@ -386,13 +608,28 @@ hse_fill(const Box& bx, Array4<Real> const& adv,
                        }
                    }
 
-                   eos_state.rho = dens_zone;
-                   eos_state.T = temp_zone;
+                   Real pres_zone;
+                   Real eint;
+
+                   if (cached) {
+                       // the pressure is only needed by the HSE integration,
+                       // which we skip for the whole column
+                       pres_zone = 0.0_rt;
+                       eint = cache_val(ii,j,k,1);
+                   } else {
+                       eos_state.rho = dens_zone;
+                       eos_state.T = temp_zone;
+
+                       eos(eos_input_rt, eos_state);
 
-                   eos(eos_input_rt, eos_state);
+                       pres_zone = eos_state.p;
+                       eint = eos_state.e;
 
-                   Real pres_zone = eos_state.p;
-                   Real eint = eos_state.e;
+                       if (use_cache) {
+                           cache_val(ii,j,k,0) = dens_zone;
+                           cache_val(ii,j,k,1) = eint;
+                       }
+                   }
 
                    //  store the final state
 
@@ -418,6 +655,10 @@ hse_fill(const Box& bx, Array4<Real> const& adv,
                    pres_below = pres_zone;
 
                 }
+
+                if (use_cache && !cached) {
+                    hse_store_column_key(cache_key, i, j, k, adv, domhi[0],j,k, domhi[0]-1,j,k);
+                }
             });
 
        }
@@ -439,6 +680,17 @@ hse_fill(const Box& bx, Array4<Real> const& adv,
             Box gbx(IntVect(D_DECL(lo[0], domlo[1]-1, lo[2])),
                     IntVect(D_DECL(hi[0], domlo[1]-1, hi[2])));
 
+            // the cached columns from the last fill of this box, if any
+
+            const bool use_cache = hse_cache == 1;
+            const Real cache_tol = hse_cache_tol;
+
+            Array4<Real> cache_key;
+            Array4<Real> cache_val;
+            if (use_cache) {
+                hse_fill_cache_arrays(geom, gbx, adv_bx, 1, 0, cache_key, cache_val);
+            }
+
             amrex::ParallelFor(gbx,
             [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
             {
@@ -480,13 +732,19 @@ hse_fill(const Box& bx, Array4<Real> const& adv,
 
                 Real pres_above = eos_state.p;
 
+                // if the interior state next to the boundary is (nearly)
+                // what it was at the last fill of this box, reuse that column
+
+                const bool cached = use_cache &&
+                    hse_column_cached(cache_key, i, j, k, adv, i,domlo[1],k, i,domlo[1]+1,k, cache_tol);
+
                 for (int jj = domlo[1]-1; jj >= adv_lo[1]; jj--) {
 
                     // HSE integration to get density, pressure
 
                     // initial guesses
 
-                    Real dens_zone = dens_above;
+                    Real dens_zone = cached ? cache_val(i,jj,k,0) : dens_above;
 
                     // temperature and species held constant in BCs
 
@@ -501,12 +759,12 @@ hse_fill(const Box& bx, Array4<Real> const& adv,
                         }
                     }
 
-                    [[maybe_unused]] bool converged_hse = false;
+                    [[maybe_unused]] bool converged_hse = cached;
 
                     Real p_want;
                     Real drho;
 
-                    for (int iter = 0; iter < hse::MAX_ITER; iter++) {
+                    for (int iter = 0; iter < hse::MAX_ITER && !cached; iter++) {
 
                         // pressure needed from HSE
 
@@ -584,13 +842,28 @@ hse_fill(const Box& bx, Array4<Real> const& adv,
                        }
                    }
 
-                   eos_state.rho = dens_zone;
-                   eos_state.T = temp_zone;
+                   Real pres_zone;
+                   Real eint;
+
+                   if (cached) {
+                       // the pressure is only needed by the HSE integration,
+                       // which we skip for the whole column
+                       pres_zone = 0.0_rt;
+                       eint = cache_val(i,jj,k,1);
+                   } else {
+                       eos_state.rho = dens_zone;
+                       eos_state.T = temp_zone;
+
+                       eos(eos_input_rt, eos_state);
 
-                   eos(eos_input_rt, eos_state);
+                       pres_zone = eos_state.p;
+                       eint = eos_state.e;
 
-                   Real pres_zone = eos_state.p;
-                   Real eint = eos_state.e;
+                       if (use_cache) {
+                           cache_val(i,jj,k,0) = dens_zone;
+                           cache_val(i,jj,k,1) = eint;
+                       }
+                   }
 
                    // store the final state
 
@@ -616,6 +889,10 @@ hse_fill(const Box& bx, Array4<Real> const& adv,
                    pres_above = pres_zone;
 
                 }
+
+                if (use_cache && !cached) {
+                    hse_store_column_key(cache_key, i, j, k, adv, i,domlo[1],k, i,domlo[1]+1,k);
+                }
             });
 
        }
@@ -633,6 +910,17 @@ hse_fill(const Box& bx, Array4<Real> const& adv,
             Box gbx(IntVect(D_DECL(lo[0], domhi[1]+1, lo[2])),
                     IntVect(D_DECL(hi[0], domhi[1]+1, hi[2])));
 
+            // the cached columns from the last fill of this box, if any
+
+            const bool use_cache = hse_cache == 1;
+            const Real cache_tol = hse_cache_tol;
+
+            Array4<Real> cache_key;
+            Array4<Real> cache_val;
+            if (use_cache) {
+                hse_fill_cache_arrays(geom, gbx, adv_bx, 1, 1, cache_key, cache_val);
+            }
+
             amrex::ParallelFor(gbx,
             [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
             {
@@ -674,12 +962,18 @@ hse_fill(const Box& bx, Array4<Real> const& adv,
 
                 Real pres_below = eos_state.p;
 
+                // if the interior state next to the boundary is (nearly)
+                // what it was at the last fill of this box, reuse that column
+
+                const bool cached = use_cache &&
+                    hse_column_cached(cache_key, i, j, k, adv, i,domhi[1],k, i,domhi[1]-1,k, cache_tol);
+
                 for (int jj = domhi[1]+1; jj <= adv_hi[1]; jj++) {
 
                     // HSE integration to get density, pressure
 
                     // initial guesses
-                    Real dens_zone = dens_below;
+                    Real dens_zone = cached ? cache_val(i,jj,k,0) : dens_below;
 
                     // temperature and species held constant in BCs
 
@@ -694,12 +988,12 @@ hse_fill(const Box& bx, Array4<Real> const& adv,
                         }
                     }
 
-                    [[maybe_unused]] bool converged_hse = false;
+                    [[maybe_unused]] bool converged_hse = cached;
 
                     Real p_want;
                     Real drho;
 
-                    for (int iter = 0; iter < hse::MAX_ITER; iter++) {
+                    for (int iter = 0; iter < hse::MAX_ITER && !cached; iter++) {
 
                         // pressure needed from HSE
                         p_want = pres_below +
@@ -776,13 +1070,28 @@ hse_fill(const Box& bx, Array4<Real> const& adv,
                        }
                    }
 
-                   eos_state.rho = dens_zone;
-                   eos_state.T = temp_zone;
+                   Real pres_zone;
+                   Real eint;
 
-                   eos(eos_input_rt, eos_state);
+                   if (cached) {
+                       // the pressure is only needed by the HSE integration,
+                       // which we skip for the whole column
+                       pres_zone = 0.0_rt;
+                       eint = cache_val(i,jj,k,1);
+                   } else {
+                       eos_state.rho = dens_zone;
+                       eos_state.T = temp_zone;
+
+                       eos(eos_input_rt, eos_state);
+
+                       pres_zone = eos_state.p;
+                       eint = eos_state.e;
 
-                   Real pres_zone = eos_state.p;
-                   Real eint = eos_state.e;
+                       if (use_cache) {
+                           cache_val(i,jj,k,0) = dens_zone;
+                           cache_val(i,jj,k,1) = eint;
+                       }
+                   }
 
                    // store the final state
 
@@ -808,6 +1117,10 @@ hse_fill(const Box& bx, Array4<Real> const& adv,
                    pres_below = pres_zone;
 
                 }
+
+                if (use_cache && !cached) {
+                    hse_store_column_key(cache_key, i, j, k, adv, i,domhi[1],k, i,domhi[1]-1,k);
+                }
             });
         }
 
@@ -828,6 +1141,17 @@ hse_fill(const Box& bx, Array4<Real> const& adv,
             Box gbx(IntVect(D_DECL(lo[0], lo[1], domlo[2]-1)),
                     IntVect(D_DECL(hi[0], hi[1], domlo[2]-1)));
 
+            // the cached columns from the last fill of this box, if any
+
+            const bool use_cache = hse_cache == 1;
+            const Real cache_tol = hse_cache_tol;
+
+            Array4<Real> cache_key;
+            Array4<Real> cache_val;
+            if (use_cache) {
+                hse_fill_cache_arrays(geom, gbx, adv_bx, 2, 0, cache_key, cache_val);
+            }
+
             amrex::ParallelFor(gbx,
             [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
             {
@@ -869,13 +1193,19 @@ hse_fill(const Box& bx, Array4<Real> const& adv,
 
                 Real pres_above = eos_state.p;
 
+                // if the interior state next to the boundary is (nearly)
+                // what it was at the last fill of this box, reuse that column
+
+                const bool cached = use_cache &&
+                    hse_column_cached(cache_key, i, j, k, adv, i,j,domlo[2], i,j,domlo[2]+1, cache_tol);
+
                 for (int kk = domlo[2]-1; kk >= adv_lo[2]; kk--) {
 
                     // HSE integration to get density, pressure
 
                     // initial guesses
 
-                    Real dens_zone = dens_above;
+                    Real dens_zone = cached ? cache_val(i,j,kk,0) : dens_above;
 
                     // temperature and species held constant in BCs
 
@@ -890,12 +1220,12 @@ hse_fill(const Box& bx, Array4<Real> const& adv,
                         }
                     }
 
-                    [[maybe_unused]] bool converged_hse = false;
+                    [[maybe_unused]] bool converged_hse = cached;
 
                     Real p_want;
                     Real drho;
 
-                    for (int iter = 0; iter < hse::MAX_ITER; iter++) {
+                    for (int iter = 0; iter < hse::MAX_ITER && !cached; iter++) {
 
                         // pressure needed from HSE
 
@@ -973,13 +1303,28 @@ hse_fill(const Box& bx, Array4<Real> const& adv,
                        }
                    }
 
-                   eos_state.rho = dens_zone;
-                   eos_state.T = temp_zone;
+                   Real pres_zone;
+                   Real eint;
 
-                   eos(eos_input_rt, eos_state);
+                   if (cached) {
+                       // the pressure is only needed by the HSE integration,
+                       // which we skip for the whole column
+                       pres_zone = 0.0_rt;
+                       eint = cache_val(i,j,kk,1);
+                   } else {
+                       eos_state.rho = dens_zone;
+                       eos_state.T = temp_zone;
 
-                   Real pres_zone = eos_state.p;
-                   Real eint = eos_state.e;
+                       eos(eos_input_rt, eos_state);
+
+                       pres_zone = eos_state.p;
+                       eint = eos_state.e;
+
+                       if (use_cache) {
+                           cache_val(i,j,kk,0) = dens_zone;
+                           cache_val(i,j,kk,1) = eint;
+                       }
+                   }
 
                    // store the final state
 
@@ -1005,6 +1350,10 @@ hse_fill(const Box& bx, Array4<Real> const& adv,
                    pres_above = pres_zone;
 
                 }
+
+                if (use_cache && !cached) {
+                    hse_store_column_key(cache_key, i, j, k, adv, i,j,domlo[2], i,j,domlo[2]+1);
+                }
             });
         }
 
@@ -0,0 +1,189 @@
+#include <AndersonAccel.H>
+
+#include <AMReX_ParallelDescriptor.H>
+
+#include <cmath>
+
+using namespace amrex;
+
+AndersonAccel::AndersonAccel (int depth_, const BoxArray& ba,
+                              const DistributionMapping& dm, int ncomp_)
+    : depth(depth_), ncomp(ncomp_),
+      F_prev(ba, dm, ncomp_, 0), G_prev(ba, dm, ncomp_, 0),
+      have_prev(false), n_accel(0)
+{
+    BL_ASSERT(depth > 0);
+}
+
+void
+AndersonAccel::reset ()
+{
+    dF.clear();
+    dG.clear();
+    have_prev = false;
+}
+
+bool
+AndersonAccel::apply (MultiFab& gx, const MultiFab& x)
+{
+    BL_PROFILE("AndersonAccel::apply()");
+
+    const BoxArray& ba = F_prev.boxArray();
+    const DistributionMapping& dm = F_prev.DistributionMap();
+
+    // residual of this iterate
+
+    MultiFab F(ba, dm, ncomp, 0);
+    MultiFab::LinComb(F, 1.0, gx, 0, -1.0, x, 0, 0, ncomp, 0);
+
+    // add the differences from the previous iterate to the history,
+    // reusing the storage of the oldest once it is full
+
+    if (have_prev) {
+        std::unique_ptr<MultiFab> dFk, dGk;
+
+        if (static_cast<int>(dF.size()) == depth) {
+            dFk = std::move(dF.front());
+            dGk = std::move(dG.front());
+            dF.erase(dF.begin());
+            dG.erase(dG.begin());
+        } else {
+            dFk.reset(new MultiFab(ba, dm, ncomp, 0));
+            dGk.reset(new MultiFab(ba, dm, ncomp, 0));
+        }
+
+        MultiFab::LinComb(*dFk, 1.0, F, 0, -1.0, F_prev, 0, 0, ncomp, 0);
+        MultiFab::LinComb(*dGk, 1.0, gx, 0, -1.0, G_prev, 0, 0, ncomp, 0);
+
+        dF.push_back(std::move(dFk));
+        dG.push_back(std::move(dGk));
+    }
+
+    MultiFab::Copy(F_prev, F, 0, 0, ncomp, 0);
+    MultiFab::Copy(G_prev, gx, 0, 0, ncomp, 0);
+    have_prev = true;
+
+    const int m = dF.size();
+
+    if (m == 0) {
+        return false;
+    }
+
+    // normal equations of min || F - sum_j gamma_j dF_j ||, with all of
+    // the dot products reduced together: the upper triangle of A
+    // followed by b
+
+    Vector<Real> dots(m * (m + 1) / 2 + m);
+
+    int n = 0;
+    for (int i = 0; i < m; ++i) {
+        for (int j = i; j < m; ++j) {
+            dots[n++] = MultiFab::Dot(*dF[i], 0, *dF[j], 0, ncomp, 0, true);
+        }
+    }
+    for (int i = 0; i < m; ++i) {
+        dots[n++] = MultiFab::Dot(*dF[i], 0, F, 0, ncomp, 0, true);
+    }
+
+    ParallelDescriptor::ReduceRealSum(dots.dataPtr(), static_cast<int>(dots.size()));
+
+    Vector<Real> A(m * m);
+    Vector<Real> gamma(m);
+
+    n = 0;
+    Real diag_max = 0.0;
+    for (int i = 0; i < m; ++i) {
+        for (int j = i; j < m; ++j) {
+            A[i*m+j] = dots[n];
+            A[j*m+i] = dots[n];
+            ++n;
+        }
+        diag_max = std::max(diag_max, A[i*m+i]);
+    }
+    for (int i = 0; i < m; ++i) {
+        gamma[i] = dots[n++];
+    }
+
+    if (diag_max <= 0.0) {
+        return false;
+    }
+
+    // a little regularization, since the differences become nearly
+    // dependent as the iteration converges
+
+    const Real reg = 1.e-12 * diag_max;
+    for (int i = 0; i < m; ++i) {
+        A[i*m+i] += reg;
+    }
+
+    // Gaussian elimination with partial pivoting
+
+    for (int k = 0; k < m; ++k) {
+        int p = k;
+        for (int i = k+1; i < m; ++i) {
+            if (std::abs(A[i*m+k]) > std::abs(A[p*m+k])) {
+                p = i;
+            }
+        }
+
+        if (std::abs(A[p*m+k]) <= reg) {
+            // the history carries no new information; start over
+            reset();
+            return false;
+        }
+
+        if (p != k) {
+            for (int j = 0; j < m; ++j) {
+                std::swap(A[k*m+j], A[p*m+j]);
+            }
+            std::swap(gamma[k], gamma[p]);
+        }
+
+        for (int i = k+1; i < m; ++i) {
+            const Real f = A[i*m+k] / A[k*m+k];
+            for (int j = k; j < m; ++j) {
+                A[i*m+j] -= f * A[k*m+j];
+            }
+            gamma[i] -= f * gamma[k];
+        }
+    }
+
+    for (int k = m-1; k >= 0; --k) {
+        for (int j = k+1; j < m; ++j) {
+            gamma[k] -= A[k*m+j] * gamma[j];
+        }
+        gamma[k] /= A[k*m+k];
+    }
+
+    // x_new = G(x) - sum_j gamma_j dG_j, reusing F for the result
+
+    MultiFab& x_new = F;
+    MultiFab::Copy(x_new, gx, 0, 0, ncomp, 0);
+    for (int j = 0; j < m; ++j) {
+        MultiFab::Saxpy(x_new, -gamma[j], *dG[j], 0, 0, ncomp, 0);
+    }
+
+    const int nc = ncomp;
+
+#ifdef _OPENMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+    for (MFIter mfi(gx, TilingIfNotGPU()); mfi.isValid(); ++mfi) {
+        const Box& bx = mfi.tilebox();
+
+        auto gx_arr = gx[mfi].array();
+        auto xn_arr = x_new[mfi].const_array();
+
+        amrex::ParallelFor(bx, nc,
+        [=] AMREX_GPU_HOST_DEVICE (int i, int j, int k, int c)
+        {
+            if (xn_arr(i,j,k,c) > 0.0_rt) {
+                gx_arr(i,j,k,c) = xn_arr(i,j,k,c);
+            }
+        });
+    }
+
+    ++n_accel;
+
+    return true;
+}
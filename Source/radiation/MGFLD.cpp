@@ -318,6 +318,8 @@ void Radiation::eos_opacity_emissivity(const MultiFab& S_new,
 
       bool use_dkdT_loc = use_dkdT;
 
+      const auto optab = opacity_tab.data();
+
       GpuArray<Real, NGROUPS> nugroup_loc;
       for (int g = 0; g < NGROUPS; ++g) {
           nugroup_loc[g] = nugroup[g];
@@ -364,7 +366,7 @@ void Radiation::eos_opacity_emissivity(const MultiFab& S_new,
 
               Real kp, kr;
 
-              opacity(kp, kr, rho, temp, Ye, nu, comp_kp, comp_kr);
+              table_opacity(optab, g, kp, kr, rho, temp, Ye, nu, comp_kp, comp_kr);
 
               kappa_p_arr(i,j,k,g) = kp;
               kappa_r_arr(i,j,k,g) = kr;
@@ -380,8 +382,8 @@ void Radiation::eos_opacity_emissivity(const MultiFab& S_new,
 
                   Real kp1, kr1, kp2, kr2;
 
-                  opacity(kp1, kr1, rho, temp-dT, Ye, nu, comp_kp, comp_kr);
-                  opacity(kp2, kr2, rho, temp+dT, Ye, nu, comp_kp, comp_kr);
+                  table_opacity(optab, g, kp1, kr1, rho, temp-dT, Ye, nu, comp_kp, comp_kr);
+                  table_opacity(optab, g, kp2, kr2, rho, temp+dT, Ye, nu, comp_kp, comp_kr);
 
                   dkdT_arr(i,j,k,g) = (kp2 - kp1) / (2.e0_rt * dT);
               }
@@ -1725,6 +1727,8 @@ void Radiation::MGFLD_compute_rosseland(FArrayBox& kappa_r, const FArrayBox& sta
   auto state_arr = state.array();
   auto kpr = kappa_r.array();
 
+  const auto optab = opacity_tab.data();
+
   GpuArray<Real, NGROUPS> nugroup_loc;
   for (int g = 0; g < NGROUPS; ++g) {
       nugroup_loc[g] = nugroup[g];
@@ -1747,7 +1751,7 @@ void Radiation::MGFLD_compute_rosseland(FArrayBox& kappa_r, const FArrayBox& sta
       bool comp_kr = true;
 
       for (int g = 0; g < NGROUPS; ++g) {
-          opacity(kp, kr, rho, temp, Ye, nugroup_loc[g], comp_kp, comp_kr);
+          table_opacity(optab, g, kp, kr, rho, temp, Ye, nugroup_loc[g], comp_kp, comp_kr);
           kpr(i,j,k,g) = kr;
       }
   });
@@ -1759,6 +1763,8 @@ void Radiation::MGFLD_compute_rosseland(MultiFab& kappa_r, const MultiFab& state
 {
     BL_PROFILE("Radiation::MGFLD_compute_rosseland (MultiFab)");
 
+    const auto optab = opacity_tab.data();
+
     GpuArray<Real, NGROUPS> nugroup_loc;
     for (int g = 0; g < NGROUPS; ++g) {
         nugroup_loc[g] = nugroup[g];
@@ -1790,7 +1796,7 @@ void Radiation::MGFLD_compute_rosseland(MultiFab& kappa_r, const MultiFab& state
             bool comp_kr = true;
 
             for (int g = 0; g < NGROUPS; ++g) {
-                opacity(kp, kr, rho, temp, Ye, nugroup_loc[g], comp_kp, comp_kr);
+                table_opacity(optab, g, kp, kr, rho, temp, Ye, nugroup_loc[g], comp_kp, comp_kr);
                 kpr(i,j,k,g) = kr;
             }
         });
@@ -1808,6 +1814,7 @@ void Radiation::MGFLD_compute_scattering(FArrayBox& kappa_s, const FArrayBox& st
 
     // scattering is assumed to be independent of nu.
     const Real nu = nugroup[0];
+    const auto optab = opacity_tab.data();
 
     amrex::ParallelFor(kbox,
     [=] AMREX_GPU_HOST_DEVICE (int i, int j, int k)
@@ -1825,7 +1832,7 @@ void Radiation::MGFLD_compute_scattering(FArrayBox& kappa_s, const FArrayBox& st
         Real kp, kr;
         bool comp_kp = true;
         bool comp_kr = true;
-        opacity(kp, kr, rho, temp, Ye, nu, comp_kp, comp_kr);
+        table_opacity(optab, 0, kp, kr, rho, temp, Ye, nu, comp_kp, comp_kr);
 
         kps(i,j,k) = amrex::max(kr - kp, 0.e0_rt);
     });
@@ -4,6 +4,7 @@
 
 #include <Radiation.H>
 #include <RadSolve.H>
+#include <AndersonAccel.H>
 
 #include <iostream>
 #include <iomanip>
@@ -58,12 +59,8 @@ void Radiation::MGFLD_implicit_update(int level, int iteration, int ncycle)
       MultiFab kpr_lag(grids,dmap,nGroups,1);
       MGFLD_compute_rosseland(kpr_lag, S_lag); 
 
-      for (int igroup=0; igroup<nGroups; ++igroup) {
-        scaledGradient(level, lambda, kpr_lag, igroup, Er_lag, igroup, 1, igroup);
-        // lambda now contains scaled gradient
-        fluxLimiter(level, lambda, igroup);
-        // lambda now contains flux limiter
-      }
+      scaledGradientFluxLimiter(level, lambda, kpr_lag, Er_lag);
+      // lambda now contains the flux limiter of every group
     }
   }
   else {
@@ -189,6 +186,17 @@ void Radiation::MGFLD_implicit_update(int level, int iteration, int ncycle)
   Real reltol_in = relInTol;
   Real ptc_tau = 0.0;  // not being used 
 
+  // Anderson acceleration of the inner iteration, on top of the local
+  // or gray acceleration.  The coefficients of the inner iteration
+  // change with each outer iteration, so the history starts over there.
+  std::unique_ptr<AndersonAccel> anderson;
+  if (anderson_depth > 0) {
+    anderson.reset(new AndersonAccel(anderson_depth, grids, dmap, nGroups));
+  }
+
+  // iteration statistics for this update
+  int total_inner_iterations = 0;
+
   // nonlinear loop for all groups
   int it = 0;
   bool conservative_update = false;
@@ -214,12 +222,8 @@ void Radiation::MGFLD_implicit_update(int level, int iteration, int ncycle)
     if (radiation::limiter>0 && inner_update_limiter==0) {
       Er_star.FillBoundary(parent->Geom(level).periodicity());
 
-      for (int igroup=0; igroup<nGroups; ++igroup) {
-        scaledGradient(level, lambda, kappa_r, igroup, Er_star, igroup, 1, igroup);
-        // lambda now contains scaled gradient
-        fluxLimiter(level, lambda, igroup);
-        // lambda now contains flux limiter
-      }
+      scaledGradientFluxLimiter(level, lambda, kappa_r, Er_star);
+      // lambda now contains the flux limiter of every group
     }
     
     // djdT is both input and output
@@ -236,8 +240,12 @@ void Radiation::MGFLD_implicit_update(int level, int iteration, int ncycle)
     inner_converged = false;
     Real relative_in_prev = 1.e200, absolute_in_prev = 1.e200;
     bool accel_allowed = true;
+    if (anderson) {
+      anderson->reset();
+    }
     do {
       innerIteration++;
+      total_inner_iterations++;
 
       MultiFab::Copy(Er_pi, Er_new, 0, 0, nGroups, 0);
 
@@ -245,11 +253,13 @@ void Radiation::MGFLD_implicit_update(int level, int iteration, int ncycle)
         if (innerIteration <= inner_update_limiter) {
           Er_pi.FillBoundary(parent->Geom(level).periodicity());
           
-          for (int igroup=0; igroup<nGroups; ++igroup) {
-            scaledGradient(level, lambda, kappa_r, igroup, Er_pi, igroup, 1, igroup);
-            // lambda now contains scaled gradient
-            fluxLimiter(level, lambda, igroup);
-            // lambda now contains flux limiter
+          scaledGradientFluxLimiter(level, lambda, kappa_r, Er_pi);
+          // lambda now contains the flux limiter of every group
+
+          // the map being accelerated has changed, so the history of
+          // the previous iterates no longer applies
+          if (anderson) {
+            anderson->reset();
           }
         }
       }
@@ -342,6 +352,13 @@ void Radiation::MGFLD_implicit_update(int level, int iteration, int ncycle)
                        etaT, eta1, mugT,
                        lambda, solver, mgbd, grids, level, time, delta_t, ptc_tau);
           } 
+
+          if (anderson) {
+            anderson->apply(Er_new, Er_pi);
+          }
+        }
+        else if (anderson) {
+          anderson->reset();
         }
       }
 
@@ -492,6 +509,16 @@ void Radiation::MGFLD_implicit_update(int level, int iteration, int ncycle)
     std::cout.precision(oldprec);
   }
 
+  if (verbose >= 1) {
+    amrex::Print() << "MGFLD implicit update on level " << level << ": "
+                   << it << " outer, " << total_inner_iterations << " inner iterations ("
+                   << total_inner_iterations * nGroups << " group solves";
+    if (anderson) {
+      amrex::Print() << ", " << anderson->num_accelerated() << " Anderson steps";
+    }
+    amrex::Print() << ")" << std::endl;
+  }
+
   if (!converged) {
       amrex::Abort("Implicit Update Failed to Converge");
   }
@@ -367,6 +367,12 @@ Radiation::Radiation(Amr* Parent, Castro* castro, int restart)
   skipAccelAllowed = 0;
   pp.query("skipAccelAllowed", skipAccelAllowed);
 
+  anderson_depth = 0;
+  pp.query("anderson_depth", anderson_depth);
+  if (anderson_depth < 0) {
+    amrex::Abort("radiation.anderson_depth must be non-negative");
+  }
+
   matter_update_type = 0;
   pp.query("matter_update_type", matter_update_type);
 
@@ -434,6 +440,7 @@ Radiation::Radiation(Amr* Parent, Castro* castro, int restart)
     std::cout << "underfac = " << underfac << std::endl;
     std::cout << "do_multigroup = " << do_multigroup << std::endl;
     std::cout << "accelerate = " << accelerate << std::endl;
+    std::cout << "anderson_depth = " << anderson_depth << std::endl;
     std::cout << "verbose  = " << verbose << std::endl;
     if (SolverType == SingleGroupSolver) {
       std::cout << "SolverType = 0: SingleGroupSolver " << std::endl;
@@ -465,6 +472,8 @@ Radiation::Radiation(Amr* Parent, Castro* castro, int restart)
     nugroup.resize(1, 1.0);
   }
 
+  opacity_tab.init(nugroup);
+
   // current implementation of the Radiation boundary condition reads
   // incoming flux information in the RadBndry constructor.  we just
   // set the boundary condition type here:
@@ -835,6 +844,7 @@ void Radiation::compute_eta(MultiFab& eta, MultiFab& etainv,
                 auto state_arr = state[mfi].array();
 
                 const Real nu = nugroup[igroup];
+                const auto optab = opacity_tab.data();
                 const Real dT_loc = dT;
 
                 amrex::ParallelFor(bx,
@@ -852,7 +862,7 @@ void Radiation::compute_eta(MultiFab& eta, MultiFab& etainv,
                     Real kp, kr;
                     bool comp_kp = true;
                     bool comp_kr = false;
-                    opacity(kp, kr, rho, temp, Ye, nu, comp_kp, comp_kr);
+                    table_opacity(optab, igroup, kp, kr, rho, temp, Ye, nu, comp_kp, comp_kr);
 
                     eta_arr(i,j,k,igroup) = kp;
                 });
@@ -1523,6 +1533,7 @@ void Radiation::get_planck_and_temp(MultiFab& fkp,
         });
 
         const Real nu = nugroup[igroup];
+        const auto optab = opacity_tab.data();
 
         amrex::ParallelFor(bx,
         [=] AMREX_GPU_HOST_DEVICE (int i, int j, int k)
@@ -1539,7 +1550,7 @@ void Radiation::get_planck_and_temp(MultiFab& fkp,
             Real kp, kr;
             bool comp_kp = true;
             bool comp_kr = false;
-            opacity(kp, kr, rho, temp, Ye, nu, comp_kp, comp_kr);
+            table_opacity(optab, igroup, kp, kr, rho, temp, Ye, nu, comp_kp, comp_kr);
 
             fkp_arr(i,j,k) = kp;
         });
@@ -1585,6 +1596,7 @@ void Radiation::get_rosseland(MultiFab& kappa_r,
   MultiFab& state = fpi.get_mf();
 
   const Real nu = nugroup[igroup];
+  const auto optab = opacity_tab.data();
 
 #ifdef _OPENMP
 #pragma omp parallel
@@ -1647,7 +1659,7 @@ void Radiation::get_rosseland(MultiFab& kappa_r,
               bool comp_kp = false;
               bool comp_kr = true;
 
-              opacity(kp, kr, rho, temp, Ye, nu, comp_kp, comp_kr);
+              table_opacity(optab, igroup, kp, kr, rho, temp, Ye, nu, comp_kp, comp_kr);
 
               kpr(i,j,k,igroup) = kr;
           });
@@ -1671,6 +1683,7 @@ void Radiation::update_rosseland_from_temp(MultiFab& kappa_r,
   BL_ASSERT(kappa_r.nComp() == Radiation::nGroups);
 
   const Real nu = nugroup[igroup];
+  const auto optab = opacity_tab.data();
 
 #ifdef _OPENMP
 #pragma omp parallel
@@ -1700,7 +1713,7 @@ void Radiation::update_rosseland_from_temp(MultiFab& kappa_r,
           bool comp_kp = false;
           bool comp_kr = true;
 
-          opacity(kp, kr, rho, temp, Ye, nu, comp_kp, comp_kr);
+          table_opacity(optab, igroup, kp, kr, rho, temp, Ye, nu, comp_kp, comp_kr);
 
           kpr(i,j,k,igroup) = kr;
       });
@@ -1715,6 +1728,7 @@ void Radiation::SGFLD_compute_rosseland(MultiFab& kappa_r, const MultiFab& state
 
   const int igroup = 0;
   const Real nu = nugroup[igroup];
+  const auto optab = opacity_tab.data();
 
 #ifdef _OPENMP
 #pragma omp parallel
@@ -1741,7 +1755,7 @@ void Radiation::SGFLD_compute_rosseland(MultiFab& kappa_r, const MultiFab& state
           bool comp_kp = false;
           bool comp_kr = true;
 
-          opacity(kp, kr, rho, temp, Ye, nu, comp_kp, comp_kr);
+          table_opacity(optab, igroup, kp, kr, rho, temp, Ye, nu, comp_kp, comp_kr);
 
           kpr(i,j,k,igroup) = kr;
       });
@@ -1756,6 +1770,7 @@ void Radiation::SGFLD_compute_rosseland(FArrayBox& kappa_r, const FArrayBox& sta
 
   const int igroup = 0;
   const Real nu = nugroup[igroup];
+  const auto optab = opacity_tab.data();
 
   auto state_arr = state.array();
   auto kpr = kappa_r.array();
@@ -1776,7 +1791,7 @@ void Radiation::SGFLD_compute_rosseland(FArrayBox& kappa_r, const FArrayBox& sta
       bool comp_kp = false;
       bool comp_kr = true;
 
-      opacity(kp, kr, rho, temp, Ye, nu, comp_kp, comp_kr);
+      table_opacity(optab, igroup, kp, kr, rho, temp, Ye, nu, comp_kp, comp_kr);
 
       kpr(i,j,k,igroup) = kr;
   });
@@ -2202,275 +2217,73 @@ void Radiation::scaledGradient(int level,
                   amrex::Abort("Unknown limiter");
               }
 
-              auto kap_arr = kappa_r[mfi].array(kcomp);
-              auto Er_arr = Erborder[mfi].array();
+              auto kap_arr = kappa_r[mfi].const_array();
+              auto Er_arr = Erborder[mfi].const_array();
+
+              // the temporary only holds the group we want
+              const int ecomp = (nGrow_Er == 0) ? 0 : igroup;
 
               amrex::ParallelFor(nbx,
               [=] AMREX_GPU_HOST_DEVICE (int i, int j, int k)
               {
-                  Real dxInv[3] = {0.0};
+                  R_arr(i,j,k) = scaled_gradient(i, j, k, idim, Er_arr, ecomp, kap_arr, kcomp,
+                                                 dx, include_cross_terms);
+              });
+          }
+      }
+  }
+}
 
-                  for (int d = 0; d < AMREX_SPACEDIM; ++d) {
-                      dxInv[d] = 1.e0_rt / dx[d];
-                  }
+// Computes the flux limiter of every group in a single pass over the
+// edges: this is scaledGradient followed by fluxLimiter, for all of
+// the groups at once.
 
-                  Real dal, dar, dbl, dbr;
-
-                  const Real tiny = 1.e-50_rt;
-
-                  if (idim == 0)
-                  {
-                      if (include_cross_terms == 1)
-                      {
-#if (AMREX_SPACEDIM >= 2)
-                          dal = Er_arr(i-1,j+1,k) - Er_arr(i-1,j-1,k);
-                          dar = Er_arr(i  ,j+1,k) - Er_arr(i  ,j-1,k);
-
-                          if      (Er_arr(i-1,j-1,k) == -1.e0_rt)
-                          {
-                              dal = 2.e0_rt * (Er_arr(i-1,j+1,k) - Er_arr(i-1,j  ,k));
-                          }
-                          else if (Er_arr(i-1,j+1,k) == -1.e0_rt)
-                          {
-                              dal = 2.e0_rt * (Er_arr(i-1,j  ,k) - Er_arr(i-1,j-1,k));
-                          }
-
-                          if      (Er_arr(i  ,j-1,k) == -1.e0_rt)
-                          {
-                              dar = 2.e0_rt * (Er_arr(i  ,j+1,k) - Er_arr(i  ,j  ,k));
-                          }
-                          else if (Er_arr(i  ,j+1,k) == -1.e0_rt)
-                          {
-                              dar = 2.e0_rt * (Er_arr(i  ,j  ,k) - Er_arr(i  ,j-1,k));
-                          }
-#else
-                          dal = 0.e0_rt;
-                          dar = 0.e0_rt;
-#endif
+void Radiation::scaledGradientFluxLimiter(int level,
+                                          Array<MultiFab, AMREX_SPACEDIM>& lambda,
+                                          MultiFab& kappa_r, MultiFab& Er)
+{
+  BL_PROFILE("Radiation::scaledGradientFluxLimiter");
+  BL_ASSERT(kappa_r.nGrow() == 1);
+  BL_ASSERT(Er.nGrow() >= 1);
+  BL_ASSERT(radiation::limiter > 0);
 
-#if (AMREX_SPACEDIM == 3)
-                          dbl = Er_arr(i-1,j,k+1) - Er_arr(i-1,j,k-1);
-                          dbr = Er_arr(i  ,j,k+1) - Er_arr(i  ,j,k-1);
-
-                          if      (Er_arr(i-1,j,k-1) == -1.e0_rt)
-                          {
-                              dbl = 2.e0_rt * (Er_arr(i-1,j,k+1) - Er_arr(i-1,j,k  ));
-                          }
-                          else if (Er_arr(i-1,j,k+1) == -1.e0_rt)
-                          {
-                              dbl = 2.e0_rt * (Er_arr(i-1,j,k  ) - Er_arr(i-1,j,k-1));
-                          }
-
-                          if      (Er_arr(i  ,j,k-1) == -1.e0_rt)
-                          {
-                              dbr = 2.e0_rt * (Er_arr(i  ,j,k+1) - Er_arr(i  ,j,k  ));
-                          }
-                          else if (Er_arr(i  ,j,k+1) == -1.e0_rt)
-                          {
-                              dbr = 2.e0_rt * (Er_arr(i  ,j,k  ) - Er_arr(i  ,j,k-1));
-                          }
-#else
-                          dbl = 0.e0_rt;
-                          dbr = 0.e0_rt;
-#endif
+  const int ngroups = lambda[0].nComp();
 
-                      }
-                      else
-                      {
-                          dal = 0.e0_rt;
-                          dar = 0.e0_rt;
-                          dbl = 0.e0_rt;
-                          dbr = 0.e0_rt;
-                      }
-
-                      Real rg;
-
-                      if (Er_arr(i-1,j,k) == -1.e0_rt)
-                      {
-                          rg = std::pow((Er_arr(i+1,j,k) - Er_arr(i,j,k)) * dxInv[0], 2) +
-                               std::pow(0.5_rt * dar * dxInv[1], 2) +
-                               std::pow(0.5_rt * dbr * dxInv[2], 2);
-                      }
-                      else if (Er_arr(i,j,k) == -1.e0_rt)
-                      {
-                          rg = std::pow((Er_arr(i-1,j,k) - Er_arr(i-2,j,k)) * dxInv[0], 2) +
-                               std::pow(0.5_rt * dal * dxInv[1], 2) +
-                               std::pow(0.5_rt * dbl * dxInv[2], 2);
-                      }
-                      else
-                      {
-                          rg = std::pow((Er_arr(i,j,k) - Er_arr(i-1,j,k)) * dxInv[0], 2) +
-                               std::pow((1.0_rt / 4.0_rt) * (dal + dar) * dxInv[1], 2) +
-                               std::pow((1.0_rt / 4.0_rt) * (dbl + dbr) * dxInv[2], 2);
-                      }
-
-                      Real kap = kavg(kap_arr(i-1,j,k), kap_arr(i,j,k), dx[0], -1);
-                      R_arr(i,j,k) = std::sqrt(rg) / (kap * amrex::max(Er_arr(i-1,j,k), Er_arr(i,j,k), tiny));
+  BL_ASSERT(kappa_r.nComp() >= ngroups);
+  BL_ASSERT(Er.nComp() >= ngroups);
 
-                  }
-                  else if (idim == 1)
-                  {
-                      if (include_cross_terms == 1)
-                      {
-                          dal = Er_arr(i+1,j-1,k  ) - Er_arr(i-1,j-1,k  );
-                          dar = Er_arr(i+1,j  ,k  ) - Er_arr(i-1,j  ,k  );
-
-                          if      (Er_arr(i-1,j-1,k  ) == -1.e0_rt)
-                          {
-                              dal = 2.e0_rt * (Er_arr(i+1,j-1,k  ) - Er_arr(i  ,j-1,k  ));
-                          }
-                          else if (Er_arr(i+1,j-1,k  ) == -1.e0_rt)
-                          {
-                              dal = 2.e0_rt * (Er_arr(i  ,j-1,k  ) - Er_arr(i-1,j-1,k  ));
-                          }
-
-                          if      (Er_arr(i-1,j  ,k  ) == -1.e0_rt)
-                          {
-                              dar = 2.e0_rt * (Er_arr(i+1,j  ,k  ) - Er_arr(i  ,j  ,k  ));
-                          }
-                          else if (Er_arr(i+1,j  ,k  ) == -1.e0_rt)
-                          {
-                              dar = 2.e0_rt * (Er_arr(i  ,j  ,k  ) - Er_arr(i-1,j  ,k  ));
-                          }
-
-#if (AMREX_SPACEDIM == 3)
-                          dbl = Er_arr(i  ,j-1,k+1) - Er_arr(i  ,j-1,k-1);
-                          dbr = Er_arr(i  ,j  ,k+1) - Er_arr(i  ,j  ,k-1);
-
-                          if      (Er_arr(i  ,j-1,k-1) == -1.e0_rt)
-                          {
-                              dbl = 2.e0_rt * (Er_arr(i  ,j-1,k+1) - Er_arr(i  ,j-1,k  ));
-                          }
-                          else if (Er_arr(i  ,j-1,k+1) == -1.e0_rt)
-                          {
-                              dbl = 2.e0_rt * (Er_arr(i  ,j-1,k  ) - Er_arr(i  ,j-1,k-1));
-                          }
-
-                          if      (Er_arr(i  ,j  ,k-1) == -1.e0_rt)
-                          {
-                              dbr = 2.e0_rt * (Er_arr(i  ,j  ,k+1) - Er_arr(i  ,j,  k  ));
-                          }
-                          else if (Er_arr(i  ,j  ,k+1) == -1.e0_rt)
-                          {
-                              dbr = 2.e0_rt * (Er_arr(i  ,j  ,k  ) - Er_arr(i  ,j,  k-1));
-                          }
-#else
-                          dbl = 0.e0_rt;
-                          dbr = 0.e0_rt;
+  int include_cross_terms = 0;
+
+  if (radiation::limiter == 1) {
+      include_cross_terms = 0;
+  } else if (radiation::limiter == 2) {
+      include_cross_terms = 1;
+  } else {
+      amrex::Abort("Unknown limiter");
+  }
+
+  auto dx = parent->Geom(level).CellSizeArray();
+
+#ifdef _OPENMP
+#pragma omp parallel
 #endif
-                      }
-                      else
-                      {
-                          dal = 0.e0_rt;
-                          dar = 0.e0_rt;
-                          dbl = 0.e0_rt;
-                          dbr = 0.e0_rt;
-                      }
-
-                      Real rg;
-
-                      if (Er_arr(i,j-1,k) == -1.e0_rt)
-                      {
-                          rg = std::pow((Er_arr(i,j+1,k) - Er_arr(i,j,k)) * dxInv[1], 2) +
-                               std::pow(0.5_rt * dar * dxInv[0], 2) +
-                               std::pow(0.5_rt * dbr * dxInv[2], 2);
-                      }
-                      else if (Er_arr(i,j,k) == -1.e0_rt)
-                      {
-                          rg = std::pow((Er_arr(i,j-1,k) - Er_arr(i,j-2,k)) * dxInv[1], 2) +
-                               std::pow(0.5_rt * dal * dxInv[0], 2) +
-                               std::pow(0.5_rt * dbl * dxInv[2], 2);
-                      }
-                      else
-                      {
-                          rg = std::pow((Er_arr(i,j,k) - Er_arr(i,j-1,k)) * dxInv[1], 2) +
-                               std::pow((1.0_rt / 4.0_rt) * (dal + dar) * dxInv[0], 2) +
-                               std::pow((1.0_rt / 4.0_rt) * (dbl + dbr) * dxInv[2], 2);
-                      }
-
-                      Real kap = kavg(kap_arr(i,j-1,k), kap_arr(i,j,k), dx[1], -1);
-                      R_arr(i,j,k) = std::sqrt(rg) / (kap * amrex::max(Er_arr(i,j-1,k), Er_arr(i,j,k), tiny));
-                  }
-                  else
-                  {
-                      if (include_cross_terms == 1)
-                      {
-                          dal = Er_arr(i+1,j  ,k-1) - Er_arr(i-1,j  ,k-1);
-                          dar = Er_arr(i+1,j  ,k  ) - Er_arr(i-1,j  ,k  );
-
-                          if      (Er_arr(i-1,j  ,k-1) == -1.e0_rt)
-                          {
-                              dal = 2.e0_rt * (Er_arr(i+1,j  ,k-1) - Er_arr(i  ,j  ,k-1));
-                          }
-                          else if (Er_arr(i+1,j  ,k-1) == -1.e0_rt)
-                          {
-                              dal = 2.e0_rt * (Er_arr(i  ,j  ,k-1) - Er_arr(i-1,j  ,k-1));
-                          }
-
-                          if      (Er_arr(i-1,j  ,k  ) == -1.e0_rt)
-                          {
-                              dar = 2.e0_rt * (Er_arr(i+1,j  ,k  ) - Er_arr(i  ,j  ,k  ));
-                          }
-                          else if (Er_arr(i+1,j  ,k  ) == -1.e0_rt)
-                          {
-                              dar = 2.e0_rt * (Er_arr(i  ,j  ,k  ) - Er_arr(i-1,j  ,k  ));
-                          }
-
-                          dbl = Er_arr(i  ,j+1,k-1) - Er_arr(i  ,j-1,k-1);
-                          dbr = Er_arr(i  ,j+1,k  ) - Er_arr(i  ,j-1,k  );
-
-                          if      (Er_arr(i  ,j-1,k-1) == -1.e0_rt)
-                          {
-                              dbl = 2.e0_rt * (Er_arr(i  ,j+1,k-1) - Er_arr(i  ,j  ,k-1));
-                          }
-                          else if (Er_arr(i  ,j+1,k-1) == -1.e0_rt)
-                          {
-                              dbl = 2.e0_rt * (Er_arr(i  ,j  ,k-1) - Er_arr(i  ,j-1,k-1));
-                          }
-
-                          if      (Er_arr(i  ,j-1,k  ) == -1.e0_rt)
-                          {
-                              dbr = 2.e0_rt * (Er_arr(i  ,j+1,k  ) - Er_arr(i  ,j,  k  ));
-                          }
-                          else if (Er_arr(i  ,j+1,k  ) == -1.e0_rt)
-                          {
-                              dbr = 2.e0_rt * (Er_arr(i  ,j  ,k  ) - Er_arr(i  ,j-1,k  ));
-                          }
-                      }
-                      else
-                      {
-                          dal = 0.e0_rt;
-                          dar = 0.e0_rt;
-                          dbl = 0.e0_rt;
-                          dbr = 0.e0_rt;
-                      }
-
-                      Real rg;
-
-                      if (Er_arr(i,j,k-1) == -1.e0_rt)
-                      {
-                          rg = std::pow((Er_arr(i,j,k+1) - Er_arr(i,j,k)) * dxInv[2], 2) +
-                               std::pow(0.5_rt * dar * dxInv[0], 2) +
-                               std::pow(0.5_rt * dbr * dxInv[1], 2);
-                      }
-                      else if (Er_arr(i,j,k) == -1.e0_rt)
-                      {
-                          rg = std::pow((Er_arr(i,j,k-1) - Er_arr(i,j,k-2)) * dxInv[2], 2) +
-                               std::pow(0.5_rt * dal * dxInv[0], 2) +
-                               std::pow(0.5_rt * dbl * dxInv[1], 2);
-                      }
-                      else
-                      {
-                          rg = std::pow((Er_arr(i,j,k) - Er_arr(i,j,k-1)) * dxInv[2], 2) +
-                               std::pow((1.0_rt / 4.0_rt) * (dal + dar) * dxInv[0], 2) +
-                               std::pow((1.0_rt / 4.0_rt) * (dbl + dbr) * dxInv[1], 2);
-                      }
-
-                      Real kap = kavg(kap_arr(i,j,k-1), kap_arr(i,j,k), dx[2], -1);
-                      R_arr(i,j,k) = std::sqrt(rg) / (kap * amrex::max(Er_arr(i,j,k-1), Er_arr(i,j,k), tiny));
-                  }
-              });
-          }
+  for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+
+      for (MFIter mfi(lambda[idim], TilingIfNotGPU()); mfi.isValid(); ++mfi) {
+
+          const Box& nbx = mfi.tilebox();  // note that lambda is edge based
+
+          auto lambda_arr = lambda[idim][mfi].array();
+          auto kap_arr = kappa_r[mfi].const_array();
+          auto Er_arr = Er[mfi].const_array();
+
+          amrex::ParallelFor(nbx, ngroups,
+          [=] AMREX_GPU_HOST_DEVICE (int i, int j, int k, int g)
+          {
+              Real R = scaled_gradient(i, j, k, idim, Er_arr, g, kap_arr, g,
+                                       dx, include_cross_terms);
+              lambda_arr(i,j,k,g) = FLDlambda(R);
+          });
       }
   }
 }
@@ -2592,6 +2405,7 @@ void Radiation::get_rosseland_v_dcf(MultiFab& kappa_r, MultiFab& v, MultiFab& dc
             S[mfi].copy<RunOn::Device>(temp,reg,0,reg,UTEMP,1);
 
             const Real nu = nugroup[igroup];
+            const auto optab = opacity_tab.data();
 
             amrex::ParallelFor(reg,
             [=] AMREX_GPU_HOST_DEVICE (int i, int j, int k)
@@ -2608,14 +2422,14 @@ void Radiation::get_rosseland_v_dcf(MultiFab& kappa_r, MultiFab& v, MultiFab& dc
                 Real kp, kr;
                 bool comp_kp = true;
                 bool comp_kr = true;
-                opacity(kp, kr, rho, temp, Ye, nu, comp_kp, comp_kr);
+                table_opacity(optab, igroup, kp, kr, rho, temp, Ye, nu, comp_kp, comp_kr);
 
                 kp_arr(i,j,k) = kp;
                 kr_arr(i,j,k) = kr;
 
                 temp += dT_loc;
 
-                opacity(kp, kr, rho, temp, Ye, nu, comp_kp, comp_kr);
+                table_opacity(optab, igroup, kp, kr, rho, temp, Ye, nu, comp_kp, comp_kr);
 
                 kp2_arr(i,j,k) = kp;
             });
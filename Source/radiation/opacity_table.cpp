@@ -0,0 +1,99 @@
+#include <AMReX_ParallelDescriptor.H>
+#include <iostream>
+
+#include <network.H>
+#include <radiation_params.H>
+#include <opacity_table.H>
+
+using namespace amrex;
+
+void
+OpacityTable::init (const Vector<Real>& nugroup)
+{
+    table = OpacityTableData{};
+
+    if (radiation::use_opacity_table == 0) {
+        return;
+    }
+
+    // The table has no Ye dimension, so it can only be used when the
+    // opacities are evaluated with Ye = 0, as they are when the network
+    // has no auxiliary data.
+
+    if (NumAux > 0) {
+        amrex::Abort("radiation.use_opacity_table requires a network without auxiliary data");
+    }
+
+    if (radiation::opacity_table_rho_min <= 0.0 ||
+        radiation::opacity_table_rho_max <= radiation::opacity_table_rho_min ||
+        radiation::opacity_table_temp_min <= 0.0 ||
+        radiation::opacity_table_temp_max <= radiation::opacity_table_temp_min) {
+        amrex::Abort("radiation.opacity_table: invalid density or temperature range");
+    }
+
+    if (radiation::opacity_table_points_per_decade < 1) {
+        amrex::Abort("radiation.opacity_table_points_per_decade must be positive");
+    }
+
+    const Real logrho_lo = std::log10(radiation::opacity_table_rho_min);
+    const Real logrho_hi = std::log10(radiation::opacity_table_rho_max);
+    const Real logtemp_lo = std::log10(radiation::opacity_table_temp_min);
+    const Real logtemp_hi = std::log10(radiation::opacity_table_temp_max);
+
+    const Real ppd = static_cast<Real>(radiation::opacity_table_points_per_decade);
+
+    const int ngroups = nugroup.size();
+    const int nrho = amrex::max(2, static_cast<int>(std::ceil((logrho_hi - logrho_lo) * ppd)) + 1);
+    const int ntemp = amrex::max(2, static_cast<int>(std::ceil((logtemp_hi - logtemp_lo) * ppd)) + 1);
+
+    const Real dlogrho = (logrho_hi - logrho_lo) / static_cast<Real>(nrho - 1);
+    const Real dlogtemp = (logtemp_hi - logtemp_lo) / static_cast<Real>(ntemp - 1);
+
+    const Long npts = static_cast<Long>(ngroups) * nrho * ntemp;
+
+    logkp.resize(npts);
+    logkr.resize(npts);
+
+    Gpu::DeviceVector<Real> nu_d(ngroups);
+    Gpu::copy(Gpu::hostToDevice, nugroup.begin(), nugroup.end(), nu_d.begin());
+
+    const Real* nu = nu_d.data();
+    Real* kp_tab = logkp.data();
+    Real* kr_tab = logkr.data();
+
+    amrex::ParallelFor(npts,
+    [=] AMREX_GPU_HOST_DEVICE (Long n)
+    {
+        const int it = n % ntemp;
+        const int ir = (n / ntemp) % nrho;
+        const int g = n / (static_cast<Long>(ntemp) * nrho);
+
+        const Real rho = std::pow(10.0_rt, logrho_lo + ir * dlogrho);
+        const Real temp = std::pow(10.0_rt, logtemp_lo + it * dlogtemp);
+
+        Real kp, kr;
+        opacity(kp, kr, rho, temp, 0.0_rt, nu[g], true, true);
+
+        kp_tab[n] = std::log10(amrex::max(kp, opacity_table::tiny));
+        kr_tab[n] = std::log10(amrex::max(kr, opacity_table::tiny));
+    });
+
+    Gpu::streamSynchronize();
+
+    table.active = 1;
+    table.ngroups = ngroups;
+    table.nrho = nrho;
+    table.ntemp = ntemp;
+    table.logrho_lo = logrho_lo;
+    table.logtemp_lo = logtemp_lo;
+    table.dlogrho = dlogrho;
+    table.dlogtemp = dlogtemp;
+    table.logkp = kp_tab;
+    table.logkr = kr_tab;
+
+    if (ParallelDescriptor::IOProcessor()) {
+        std::cout << "opacity table: " << ngroups << " groups, "
+                  << nrho << " densities, " << ntemp << " temperatures ("
+                  << 2 * npts * sizeof(Real) / (1024 * 1024) << " MB)" << std::endl;
+    }
+}
@@ -27,6 +27,8 @@ Castro::do_old_reactions (Real time, Real dt)
 
     if (time_integration_method != SimplifiedSpectralDeferredCorrections) {
         // The result of the reactions is added directly to Sborder.
+        finish_sborder_fill();
+
         burn_success = react_state(Sborder, R_old, time, 0.5 * dt, 0);
 
         if (burn_success != 1) {
@@ -196,6 +198,8 @@ Castro::react_state(MultiFab& s, MultiFab& r, Real time, Real dt, const int stra
     for (MFIter mfi(s, TilingIfNotGPU()); mfi.isValid(); ++mfi)
     {
 
+        const Real cost_start = Work_Estimate_Type >= 0 ? amrex::second() : 0.0_rt;
+
         const Box& bx = mfi.growntilebox(ng);
 
         auto U = s.array(mfi);
@@ -404,6 +408,10 @@ Castro::react_state(MultiFab& s, MultiFab& r, Real time, Real dt, const int stra
 
         });
 
+        if (Work_Estimate_Type >= 0) {
+            add_box_cost(mfi, cost_start);
+        }
+
     }
 
     ReduceTuple hv = reduce_data.value();
@@ -413,18 +421,28 @@ Castro::react_state(MultiFab& s, MultiFab& r, Real time, Real dt, const int stra
       burn_success = 0;
     }
 
-    ParallelDescriptor::ReduceIntMin(burn_success);
+    // the failure flag and the diagnostic share one reduction
 
-    if (print_update_diagnostics) {
+    ReductionQueue rq;
 
-        Real e_added = r.sum(0);
+    const int success_h = rq.add(static_cast<Real>(burn_success), ReductionQueue::Min);
 
-        if (e_added != 0.0) {
-            amrex::Print() << "... (rho e) added from burning: " << e_added * dt << std::endl << std::endl;
-        }
+    if (print_update_diagnostics) {
+        const int e_added_h = rq.add(r.sum(0, true), ReductionQueue::Sum);
 
+        rq.then([&rq, e_added_h, dt] () {
+            Real e_added = rq.get(e_added_h);
+
+            if (e_added != 0.0) {
+                amrex::Print() << "... (rho e) added from burning: " << e_added * dt << std::endl << std::endl;
+            }
+        });
     }
 
+    burn_success = static_cast<int>(rq.get(success_h));
+
+    rq.complete();
+
     if (verbose) {
         amrex::Print() << "... Leaving burner on level " << level << " after completing half-timestep of burning." << std::endl << std::endl;
     }
@@ -523,6 +541,8 @@ Castro::react_state(Real time, Real dt)
 
     for (MFIter mfi(S_new, TilingIfNotGPU()); mfi.isValid(); ++mfi)
     {
+        const Real cost_start = Work_Estimate_Type >= 0 ? amrex::second() : 0.0_rt;
+
         const Box& bx = mfi.growntilebox(ng);
 
         auto U_old = S_old.array(mfi);
@@ -782,6 +802,10 @@ Castro::react_state(Real time, Real dt)
 
             return {burn_failed};
         });
+
+        if (Work_Estimate_Type >= 0) {
+            add_box_cost(mfi, cost_start);
+        }
     }
 
     ReduceTuple hv = reduce_data.value();
@@ -791,7 +815,25 @@ Castro::react_state(Real time, Real dt)
         burn_success = 0;
     }
 
-    ParallelDescriptor::ReduceIntMin(burn_success);
+    // the failure flag and the diagnostic share one reduction, which
+    // completes behind the ghost cell fills
+
+    ReductionQueue rq;
+
+    const int success_h = rq.add(static_cast<Real>(burn_success), ReductionQueue::Min);
+
+    if (print_update_diagnostics) {
+        const int e_added_h = rq.add(reactions.sum(0, true), ReductionQueue::Sum);
+
+        rq.then([&rq, e_added_h, dt] () {
+            Real e_added = rq.get(e_added_h);
+
+            if (e_added != 0.0)
+                amrex::Print() << "... (rho e) added from burning: " << e_added * dt << std::endl << std::endl;
+        });
+    }
+
+    rq.start();
 
     if (ng > 0) {
         S_new.FillBoundary(geom.periodicity());
@@ -800,14 +842,9 @@ Castro::react_state(Real time, Real dt)
     Real cur_time = get_state_data(Simplified_SDC_React_Type).curTime();
     AmrLevel::FillPatch(*this, SDC_react, SDC_react.nGrow(), cur_time, Simplified_SDC_React_Type, 0, SDC_react.nComp());
 
-    if (print_update_diagnostics) {
-
-        Real e_added = reactions.sum(0);
+    burn_success = static_cast<int>(rq.get(success_h));
 
-        if (e_added != 0.0)
-            amrex::Print() << "... (rho e) added from burning: " << e_added * dt << std::endl << std::endl;
-
-    }
+    rq.complete();
 
     if (verbose) {
 
@@ -861,75 +898,44 @@ Castro::valid_zones_to_burn(MultiFab& State)
       return true;
     }
 
-    // Now, if we're limiting on rho, collect the
-    // minimum and/or maximum and compare.
+    // Now, if we're limiting on rho, collect the local minimum
+    // and/or maximum, and reduce them all at once. We're being
+    // careful here to limit the amount of work and communication,
+    // because regularly doing this check only makes sense
+    // if it is negligible compared to the amount of work
+    // needed to just do the burn as normal.
 
-    amrex::Vector<Real> small_limiters;
-    amrex::Vector<Real> large_limiters;
+    ReductionQueue rq;
 
     bool local = true;
 
     Real smalldens = small;
     Real largedens = large;
+    Real small_T = small;
+    Real large_T = large;
+
+    const int smalldens_h = limit_small_rho ? rq.add(State.min(URHO, 0, local), ReductionQueue::Min) : -1;
+    const int largedens_h = limit_large_rho ? rq.add(State.max(URHO, 0, local), ReductionQueue::Max) : -1;
+    const int small_T_h = limit_small_T ? rq.add(State.min(UTEMP, 0, local), ReductionQueue::Min) : -1;
+    const int large_T_h = limit_large_T ? rq.add(State.max(UTEMP, 0, local), ReductionQueue::Max) : -1;
 
     if (limit_small_rho) {
-      smalldens = State.min(URHO, 0, local);
-      small_limiters.push_back(smalldens);
+        smalldens = rq.get(smalldens_h);
     }
 
     if (limit_large_rho) {
-      largedens = State.max(URHO, 0, local);
-      large_limiters.push_back(largedens);
+        largedens = rq.get(largedens_h);
     }
 
-    Real small_T = small;
-    Real large_T = large;
-
     if (limit_small_T) {
-      small_T = State.min(UTEMP, 0, local);
-      small_limiters.push_back(small_T);
+        small_T = rq.get(small_T_h);
     }
 
     if (limit_large_T) {
-      large_T = State.max(UTEMP, 0, local);
-      large_limiters.push_back(large_T);
-    }
-
-    // Now do the reductions. We're being careful here
-    // to limit the amount of work and communication,
-    // because regularly doing this check only makes sense
-    // if it is negligible compared to the amount of work
-    // needed to just do the burn as normal.
-
-    int small_size = static_cast<int>(small_limiters.size());
-
-    if (small_size > 0) {
-        amrex::ParallelDescriptor::ReduceRealMin(small_limiters.dataPtr(), small_size);
-
-        if (limit_small_rho) {
-            smalldens = small_limiters[0];
-            if (limit_small_T) {
-                small_T = small_limiters[1];
-            }
-        } else {
-            small_T = small_limiters[0];
-        }
+        large_T = rq.get(large_T_h);
     }
 
-    int large_size = static_cast<int>(large_limiters.size());
-
-    if (large_size > 0) {
-        amrex::ParallelDescriptor::ReduceRealMax(large_limiters.dataPtr(), large_size);
-
-        if (limit_large_rho) {
-            largedens = large_limiters[0];
-            if (limit_large_T) {
-                large_T = large_limiters[1];
-            }
-        } else {
-            large_T = large_limiters[1];
-        }
-    }
+    rq.complete();
 
     // Finally check on whether min <= rho <= max
     // and min <= T <= max. The defaults are small
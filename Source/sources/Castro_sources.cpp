@@ -50,7 +50,8 @@ Castro::source_flag(int src)
         }
 #ifndef MHD
     case thermo_src:
-        if (time_integration_method == SpectralDeferredCorrections) {
+        if (time_integration_method == SpectralDeferredCorrections ||
+            time_integration_method == LowStorageRungeKutta) {
             return true;
         } else {
           return false;
@@ -69,8 +70,9 @@ Castro::source_flag(int src)
 
 #ifdef DIFFUSION
     case diff_src:
-        if (diffuse_temp &&
-            !(time_integration_method == SpectralDeferredCorrections)) {
+        if (diffuse_temp && diffusion_method == 0 &&
+            !(time_integration_method == SpectralDeferredCorrections ||
+              time_integration_method == LowStorageRungeKutta)) {
           return true;
         }
         else {
@@ -188,6 +190,12 @@ Castro::do_old_sources (Real time, Real dt)
     MultiFab& Bz_old = get_old_data(Mag_Type_z);
 #endif
 
+    // The source terms are evaluated on the ghost zones of Sborder.
+
+    if (apply_sources()) {
+        finish_sborder_fill();
+    }
+
     do_old_sources(
 #ifdef MHD
                    Bx_old, By_old, Bz_old,
@@ -310,7 +318,8 @@ Castro::construct_old_source(int src, MultiFab& source, MultiFab& state_in, Real
 
 #ifdef DIFFUSION
     case diff_src:
-        if (!(time_integration_method == SpectralDeferredCorrections)) {
+        if (!(time_integration_method == SpectralDeferredCorrections ||
+              time_integration_method == LowStorageRungeKutta)) {
           // for MOL or SDC, we'll compute a diffusive flux in the MOL routine
           construct_old_diff_source(source, state_in, time, dt);
         }
@@ -487,22 +496,26 @@ Castro::evaluate_and_print_source_change (const MultiFab& source, Real dt, const
     bool local = true;
     Vector<Real> update = evaluate_source_change(source, dt, local);
 
-#ifdef BL_LAZY
-    Lazy::QueueReduction( [=] () mutable {
-#endif
-        ParallelDescriptor::ReduceRealSum(update.dataPtr(), static_cast<int>(update.size()), ParallelDescriptor::IOProcessorNumber());
+    // Queue the sums; all the diagnostics of the step are reduced
+    // together in post_timestep.
+
+    const int n = static_cast<int>(update.size());
+    const int h = source_change_reductions.add(update.dataPtr(), n, ReductionQueue::Sum);
+
+    source_change_reductions.then([=] () {
+        Vector<Real> global_update(n);
+        for (int i = 0; i < n; ++i) {
+            global_update[i] = source_change_reductions.get(h + i);
+        }
 
         if (ParallelDescriptor::IOProcessor()) {
-            if (std::abs(update[URHO]) != 0.0 || std::abs(update[UEDEN]) != 0.0) {
+            if (std::abs(global_update[URHO]) != 0.0 || std::abs(global_update[UEDEN]) != 0.0) {
                 std::cout << std::endl << "  Contributions to the state from " << source_name << ":" << std::endl;
 
-                print_source_change(update);
+                print_source_change(global_update);
             }
         }
-
-#ifdef BL_LAZY
     });
-#endif
 }
 
 // For the old-time or new-time sources update, evaluate the change in the state
@@ -544,13 +557,21 @@ Castro::pre_advance_operators (Real time, Real dt)
     // If we are using gravity, solve for the potential and gravitational field.
 
 #ifdef GRAVITY
+    const Real grav_start = amrex::second();
+
     construct_old_gravity(time);
+
+    add_level_cost(amrex::second() - grav_start);
 #endif
 
     // Initialize the new-time data. This copy needs to come after all Strang-split operators.
 
     MultiFab& S_new = get_new_data(State_Type);
 
+    if (S_new.nGrow() > 0) {
+        finish_sborder_fill();
+    }
+
     MultiFab::Copy(S_new, Sborder, 0, 0, NUM_STATE, S_new.nGrow());
 
     return status;
@@ -593,7 +614,11 @@ Castro::post_hydro_operators (Real time, Real dt)
     advance_status status {};
 
 #ifdef GRAVITY
+    const Real grav_start = amrex::second();
+
     construct_new_gravity(time);
+
+    add_level_cost(amrex::second() - grav_start);
 #endif
 
     return status;
@@ -606,6 +631,19 @@ Castro::post_advance_operators (Real time, Real dt)
 {
     advance_status status {};
 
+#ifdef DIFFUSION
+    // Operator-split thermal diffusion comes before the second half of
+    // the burn, so the burn sees the diffused temperature.
+
+    if (diffuse_temp && diffusion_method != 0) {
+        status = do_split_temp_diffusion(time, dt);
+
+        if (status.success == false) {
+            return status;
+        }
+    }
+#endif
+
 #ifndef TRUE_SDC
 #ifdef REACTIONS
     status = do_new_reactions(time, dt);
@@ -11,7 +11,8 @@ Castro::construct_old_thermo_source(MultiFab& source, MultiFab& state_in,
     amrex::ignore_unused(dt);
 
 #ifndef MHD
-  if (!(time_integration_method == SpectralDeferredCorrections)) {
+  if (!(time_integration_method == SpectralDeferredCorrections ||
+        time_integration_method == LowStorageRungeKutta)) {
       return;
   }
 #endif
@@ -60,7 +61,8 @@ Castro::construct_new_thermo_source(MultiFab& source, MultiFab& state_old, Multi
     amrex::ignore_unused(dt);
 
 #ifndef MHD
-  if (!(time_integration_method == SpectralDeferredCorrections)) {
+  if (!(time_integration_method == SpectralDeferredCorrections ||
+        time_integration_method == LowStorageRungeKutta)) {
       return;
   }
 
@@ -11,6 +11,8 @@
 #include <cstdio>
 #include <vector>
 #include <string>
+#include <map>
+#include <memory>
 
 #ifndef WIN32
 #include <unistd.h>
@@ -24,6 +26,8 @@
 #include <AMReX_DataServices.H>
 #include <AMReX_Utility.H>
 #include <AMReX_VisMF.H>
+#include <AMReX_MultiFabUtil.H>
+#include <AMReX_DistributionMapping.H>
 #include <AMReX_Geometry.H>
 #include <AMReX_StateDescriptor.H>
 #include <AMReX_StateData.H>
@@ -55,7 +59,11 @@ int num_new_levels(1);
 int      ref_ratio(1);
 int   grown_factor(1);
 int star_at_center(-1);
-int   max_grid_size(4096);
+int   max_grid_size(-1);
+int blocking_factor(1);
+int n_proper(1);
+int regrid_old_levels(0);
+std::string dmap_strategy("SFC");
 int   coord(-1);
 const std::string CheckPointVersion = "CheckPointVersion_1.0";
 
@@ -74,8 +82,10 @@ struct FakeStateData {
     BoxArray grids;
     TimeInterval new_time;
     TimeInterval old_time;
-    MultiFab *new_data;
-    MultiFab *old_data;
+    // full path of the MultiFabs in the input checkpoint; these are
+    // empty for the new coarse levels, whose data we average down
+    std::string new_data_file;
+    std::string old_data_file;
     Vector< Vector<BCRec> > bc;
 };
 
@@ -86,6 +96,7 @@ struct FakeAmrLevel {
     BoxArray grids;                   // Cell-centered locations of grids.
     IntVect crse_ratio;               // Refinement ratio to coarser level.
     IntVect fine_ratio;               // Refinement ratio to finer level.
+    IntVect shift{IntVect::TheZeroVector()}; // Shift from the input index space.
     Vector<FakeStateData> state;       // Array of state data.
     Vector<FakeStateData> new_state;   // Array of new state data.
 };
@@ -131,6 +142,25 @@ static void ScanArguments() {
       pp.get("grown_factor", grown_factor);
     }
 
+    if(pp.contains("num_new_levels")) {
+      pp.get("num_new_levels", num_new_levels);
+    }
+    if(pp.contains("max_grid_size")) {
+      pp.get("max_grid_size", max_grid_size);
+    }
+    if(pp.contains("blocking_factor")) {
+      pp.get("blocking_factor", blocking_factor);
+    }
+    if(pp.contains("n_proper")) {
+      pp.get("n_proper", n_proper);
+    }
+    if(pp.contains("regrid")) {
+      pp.get("regrid", regrid_old_levels);
+    }
+    if(pp.contains("dmap_strategy")) {
+      pp.get("dmap_strategy", dmap_strategy);
+    }
+
     pp.get("star_at_center", star_at_center);
 
     if (star_at_center != 0 && star_at_center != 1)
@@ -139,12 +169,27 @@ static void ScanArguments() {
     if (ref_ratio != 2 && ref_ratio != 4)
        amrex::Abort("ref_ratio must be 2 or 4");
 
-    if (grown_factor <= 1)  
-        amrex::Abort("must have grown_factor > 1");
+    if (grown_factor < 1)
+        amrex::Abort("must have grown_factor >= 1");
 
     if (star_at_center == 1)  
        if (grown_factor != 2 && grown_factor != 3)
           amrex::Abort("must have grown_factor = 2 or 3 for star at center");
+
+    if (num_new_levels < 0)
+       amrex::Abort("must have num_new_levels >= 0");
+
+    if (blocking_factor < 1)
+       amrex::Abort("must have blocking_factor >= 1");
+
+    if (n_proper < 1)
+       amrex::Abort("must have n_proper >= 1");
+
+    if (max_grid_size > 0 && max_grid_size % blocking_factor != 0)
+       amrex::Abort("max_grid_size must be a multiple of blocking_factor");
+
+    if (dmap_strategy != "SFC" && dmap_strategy != "KNAPSACK" && dmap_strategy != "ROUNDROBIN")
+       amrex::Abort("dmap_strategy must be SFC, KNAPSACK or ROUNDROBIN");
 }
 
 // ---------------------------------------------------------------
@@ -154,11 +199,28 @@ static void PrintUsage (char *progName) {
          << "ref_ratio= 2 or 4 "   
          << "grown_factor=integer "   
          << "star_at_center =0 or 1  "   
+         << "[num_new_levels=integer] "
+         << "[max_grid_size=integer] "
+         << "[blocking_factor=integer] "
+         << "[n_proper=integer] "
+         << "[regrid=0 or 1] "
+         << "[dmap_strategy=SFC, KNAPSACK or ROUNDROBIN] "
          << "[nfiles=nfilesout] "
          << "[verbose=trueorfalse]" << endl;
     exit(1);
 }
 
+// ---------------------------------------------------------------
+// Join a directory and a name relative to it.
+static std::string JoinPath (const std::string& dir, const std::string& name) {
+    std::string path = dir;
+    if( ! path.empty() && path[path.length()-1] != '/') {
+      path += '/';
+    }
+    path += name;
+    return path;
+}
+
 // ---------------------------------------------------------------
 
 static void ReadCheckpointFile(const std::string& fileName) {
@@ -209,7 +271,7 @@ static void ReadCheckpointFile(const std::string& fileName) {
        std::cout << "previous finest_lev is " << fakeAmr.finest_level <<  std::endl;
 
     // ADDING LEVELS 
-    int n = num_new_levels;
+    const int n = num_new_levels;
     mx_lev = mx_lev + n;
     fakeAmr.finest_level = fakeAmr.finest_level + n;
 
@@ -235,93 +297,101 @@ static void ReadCheckpointFile(const std::string& fileName) {
 
     if(ParallelDescriptor::IOProcessor()) {
        std::cout << " " << std::endl;
-       for (i = 1; i <= mx_lev; i++) {
-          std::cout << "Old checkpoint level    " << i-1 << std::endl;
+       for (i = n; i <= mx_lev; i++) {
+          std::cout << "Old checkpoint level    " << i-n << std::endl;
           std::cout << " ... domain is       " << fakeAmr.geom[i].Domain() << std::endl;
           std::cout << " ...     dx is       " << fakeAmr.geom[i].CellSize()[0] << std::endl;
           std::cout << "  " << std::endl;
        }
     }
 
-    // Make sure current domain is divisible by 2*ref_ratio so length of coarsened domain is even
-    Box dom0(fakeAmr.geom[0].Domain());
-    for (int d = 0; d < AMREX_SPACEDIM; d++)
+    // Make sure current domain is divisible by 2*ref_ratio**n so length of coarsened domain is even
+    int rr_total = 1;
+    for (int lev = 0; lev < n; lev++) {
+      rr_total *= ref_ratio;
+    }
+    Box dom0(fakeAmr.geom[n].Domain());
+    for (int d = 0; d < AMREX_SPACEDIM && n > 0; d++)
     {
       int dlen = dom0.size()[d];
-      int scaled = dlen / (2*ref_ratio);
-      if ( (scaled * 2 * ref_ratio) != dlen )
-        amrex::Abort("must have domain divisible by 2*ref_ratio");
+      int scaled = dlen / (2*rr_total);
+      if ( (scaled * 2 * rr_total) != dlen )
+        amrex::Abort("must have domain divisible by 2*ref_ratio**num_new_levels");
     }
 
-    if (grown_factor <= 1)  
-        amrex::Abort("must have grown_factor > 1");
-
-    for (i = 1; i <  mx_lev; i++) {
+    for (i = n; i <  mx_lev; i++) {
       is >> fakeAmr.ref_ratio[i];
     }
-    for (i = 1; i <= mx_lev; i++) {
+    for (i = n; i <= mx_lev; i++) {
       is >> fakeAmr.dt_level[i];
     }
 
-    Box          domain(fakeAmr.geom[1].Domain());
-    RealBox prob_domain(fakeAmr.geom[1].ProbDomain());
-    coord = fakeAmr.geom[1].Coord();
-
-    // Define domain for new levels
-    domain.coarsen(ref_ratio);
-    fakeAmr.geom[0].define(domain,&prob_domain,coord);
-
-    // Define ref_ratio for new levels
-    fakeAmr.ref_ratio[0] = ref_ratio * IntVect::TheUnitVector();
-
-    // Define dt_level for new levels
-    fakeAmr.dt_level[0] = fakeAmr.dt_level[1] * ref_ratio;
-
     if (new_checkpoint_format) {
-      for (i = 1; i <= mx_lev; i++) is >> fakeAmr.dt_min[i];
-      fakeAmr.dt_min[0] = fakeAmr.dt_min[1] * ref_ratio;
-    } else {
-      for (i = 0; i <= mx_lev; i++) fakeAmr.dt_min[i] = fakeAmr.dt_level[i];
+      for (i = n; i <= mx_lev; i++) is >> fakeAmr.dt_min[i];
     }
 
     // READING N_CYCLE, LEVEL_STEPS, LEVEL_COUNT
-    for (i = 1; i <= mx_lev; i++) {
+    for (i = n; i <= mx_lev; i++) {
       is >> fakeAmr.n_cycle[i];
     }
 
-    for (i = 1; i <= mx_lev; i++) {
+    for (i = n; i <= mx_lev; i++) {
       is >> fakeAmr.level_steps[i];
     }
-    for (i = 1; i <= mx_lev; i++) {
+    for (i = n; i <= mx_lev; i++) {
       is >> fakeAmr.level_count[i];
     }
 
+    Box          domain(fakeAmr.geom[n].Domain());
+    RealBox prob_domain(fakeAmr.geom[n].ProbDomain());
+    coord = fakeAmr.geom[n].Coord();
+
     // ADDING LEVELS
 
-    // n_cycle is always equal to 1 at the coarsest level 
-    fakeAmr.n_cycle[0] = 1;
+    // Each new level is a factor of ref_ratio coarser than the one above it
+    for (int lev = n-1; lev >= 0; lev--) {
 
-    // At the old coarsest level, which is now level 1, we set n_cycle to ref_ratio 
-    fakeAmr.n_cycle[1] = ref_ratio;
+      // Define domain for new levels
+      domain.coarsen(ref_ratio);
+      fakeAmr.geom[lev].define(domain,&prob_domain,coord);
 
-    fakeAmr.level_steps[0] = fakeAmr.level_steps[1] / ref_ratio;  
-    if ( (fakeAmr.level_steps[0]*ref_ratio) != fakeAmr.level_steps[1] ) 
-       amrex::Abort("Number of steps in original checkpoint must be divisible by ref_ratio");
+      // Define ref_ratio for new levels
+      fakeAmr.ref_ratio[lev] = ref_ratio * IntVect::TheUnitVector();
 
-    // level_count is how many steps we've taken at this level since the last regrid
-    if (fakeAmr.level_count[1] == fakeAmr.level_steps[1]) 
-    {
-       fakeAmr.level_count[0] = fakeAmr.level_steps[0];
+      // Define dt_level for new levels
+      fakeAmr.dt_level[lev] = fakeAmr.dt_level[lev+1] * ref_ratio;
+      fakeAmr.dt_min[lev] = fakeAmr.dt_min[lev+1] * ref_ratio;
 
-    // this is actually wrong but should work for now
-    } else {
-       fakeAmr.level_count[0] = std::min(fakeAmr.level_count[1],fakeAmr.level_steps[0]);;
+      // The level above now takes ref_ratio steps per step at this level
+      fakeAmr.n_cycle[lev+1] = ref_ratio;
+
+      fakeAmr.level_steps[lev] = fakeAmr.level_steps[lev+1] / ref_ratio;
+      if ( (fakeAmr.level_steps[lev]*ref_ratio) != fakeAmr.level_steps[lev+1] )
+         amrex::Abort("Number of steps in original checkpoint must be divisible by ref_ratio**num_new_levels");
+
+      // level_count is how many steps we've taken at this level since the last regrid
+      if (fakeAmr.level_count[lev+1] == fakeAmr.level_steps[lev+1])
+      {
+         fakeAmr.level_count[lev] = fakeAmr.level_steps[lev];
+
+      // this is actually wrong but should work for now
+      } else {
+         fakeAmr.level_count[lev] = std::min(fakeAmr.level_count[lev+1],fakeAmr.level_steps[lev]);
+      }
     }
 
-    int ndesc_save;
+    if (!new_checkpoint_format) {
+      for (i = 0; i <= mx_lev; i++) fakeAmr.dt_min[i] = fakeAmr.dt_level[i];
+    }
+
+    // n_cycle is always equal to 1 at the coarsest level 
+    fakeAmr.n_cycle[0] = 1;
+
+    int ndesc_save = 0;
 
-    // READ LEVEL DATA
-    for(int lev(1); lev <= fakeAmr.finest_level; ++lev) {
+    // READ LEVEL DATA -- only the header information; the FABs are
+    // streamed from disk when we write the new checkpoint
+    for(int lev(n); lev <= fakeAmr.finest_level; ++lev) {
       
       FakeAmrLevel &falRef = fakeAmr.fakeAmrLevels[lev];
 
@@ -352,7 +422,7 @@ static void ReadCheckpointFile(const std::string& fileName) {
       ndesc_save = ndesc;
 
       // ndesc depends on which descriptor so we store a value for each
-      if (lev == 1) nsets_save.resize(ndesc_save);
+      if (lev == n) nsets_save.resize(ndesc_save);
 
       falRef.state.resize(ndesc);
       falRef.new_state.resize(ndesc);
@@ -374,38 +444,21 @@ static void ReadCheckpointFile(const std::string& fileName) {
 
         nsets_save[i] = nsets;
 
-        falRef.state[i].old_data = 0;
-        falRef.state[i].new_data = 0;
-
         std::string mf_name;
-        std::string FullPathName;
 
-        // This reads the "new" data, if it's there
+        // Note that mf_name is relative to the Header file.
+        // We need to prepend the name of the fileName directory.
+
+        // This is the "new" data, if it's there
         if (nsets >= 1) {
-           falRef.state[i].new_data = new MultiFab;
            is >> mf_name;
-           // Note that mf_name is relative to the Header file.
-           // We need to prepend the name of the fileName directory.
-           FullPathName = fileName;
-           if( ! fileName.empty() && fileName[fileName.length()-1] != '/') {
-             FullPathName += '/';
-           }
-           FullPathName += mf_name;
-           VisMF::Read(*(falRef.state[i].new_data), FullPathName);
+           falRef.state[i].new_data_file = JoinPath(fileName, mf_name);
         }
 
-        // This reads the "old" data, if it's there
+        // This is the "old" data, if it's there
         if (nsets == 2) {
-          falRef.state[i].old_data = new MultiFab;
-          is >> mf_name;
-          // Note that mf_name is relative to the Header file.
-          // We need to prepend the name of the fileName directory.
-          FullPathName = fileName;
-          if( ! fileName.empty() && fileName[fileName.length()-1] != '/') {
-            FullPathName += '/';
-	  }
-          FullPathName += mf_name;
-          VisMF::Read(*(falRef.state[i].old_data), FullPathName);
+           is >> mf_name;
+           falRef.state[i].old_data_file = JoinPath(fileName, mf_name);
         }
 
       }
@@ -413,26 +466,29 @@ static void ReadCheckpointFile(const std::string& fileName) {
 
     FakeAmrLevel &falRef_orig = fakeAmr.fakeAmrLevels[n];
 
-    // Compute the effective max_grid_size
-    int max_len = 0;
-    BoxArray g(fakeAmr.fakeAmrLevels[n].grids);
-    for (int b = 0; b < g.size(); b++)
-       for (int d = 0; d < AMREX_SPACEDIM; d++)
-         max_len = std::max(max_len, g[b].length(d));
-    max_grid_size = max_len;
+    // Unless it was given, compute the effective max_grid_size from
+    // the coarsest level of the original checkpoint
+    if (max_grid_size <= 0) {
+      int max_len = 0;
+      BoxArray g(falRef_orig.grids);
+      for (int b = 0; b < g.size(); b++)
+         for (int d = 0; d < AMREX_SPACEDIM; d++)
+           max_len = std::max(max_len, g[b].length(d));
+      max_grid_size = blocking_factor * ((max_len + blocking_factor - 1) / blocking_factor);
+    }
 
     // Add new level data
     for(int lev(n-1); lev >= 0; lev--) {
       FakeAmrLevel &falRef = fakeAmr.fakeAmrLevels[lev];
       falRef.level = lev;
 
-      // This version breaks up the new coarser domain based on the computed max_grid_size
-      BoxArray new_grids(domain);
-      new_grids.maxSize(max_grid_size);
-
-      falRef.grids = new_grids;
+      // Start with the whole domain; RegridLevels replaces this by the
+      // grids around the level above (except on level 0), broken up
+      // based on max_grid_size and blocking_factor
+      const Box& lev_domain = fakeAmr.geom[lev].Domain();
+      falRef.grids = BoxArray(lev_domain);
 
-      falRef.geom.define(domain,&prob_domain,coord);
+      falRef.geom.define(lev_domain,&prob_domain,coord);
 
       if(falRef.level > 0) 
         falRef.crse_ratio = ref_ratio * IntVect::TheUnitVector();
@@ -443,30 +499,270 @@ static void ReadCheckpointFile(const std::string& fileName) {
 
       for(int i = 0; i < ndesc_save; i++) {
 
-        falRef.state[i].domain = domain;
+        falRef.state[i].domain = lev_domain;
         falRef.state[i].grids = falRef.grids;
         falRef.state[i].new_time.start = falRef_orig.state[i].new_time.start;
         falRef.state[i].new_time.stop  = falRef_orig.state[i].new_time.stop;
         falRef.state[i].old_time.start = falRef.state[i].new_time.start - fakeAmr.dt_level[lev];
         falRef.state[i].old_time.stop  = falRef.state[i].new_time.stop  - fakeAmr.dt_level[lev];
 
-        falRef.state[i].old_data = 0;
-        falRef.state[i].new_data = 0;
+      }
+    }
+}
+
+// ---------------------------------------------------------------
+// Break up the grids at the new coarse levels (and at the original
+// levels too, if regrid = 1) so that every grid is aligned with
+// blocking_factor and no longer than max_grid_size.  The grids are
+// merged first, so max_grid_size can grow as well as shrink.
+static BoxArray ChopGrids (const BoxArray& grids) {
+    BoxList bl(grids);
+    bl.simplify();
+    BoxArray ba(bl);
+
+    if (blocking_factor > 1) {
+      // coarsening grows any box that is not aligned to the blocking factor
+      ba.coarsen(blocking_factor);
+      ba.removeOverlap();
+      ba.maxSize(max_grid_size / blocking_factor);
+      ba.refine(blocking_factor);
+    } else {
+      ba.maxSize(max_grid_size);
+    }
+
+    return ba;
+}
+
+// ---------------------------------------------------------------
+// Set the grids of a level we regrid.
+static void SetLevelGrids (int lev, const BoxArray& grids) {
+    if (blocking_factor > 1 && ! fakeAmr.geom[lev].Domain().coarsenable(blocking_factor))
+      amrex::Abort("must have domain divisible by blocking_factor at every level we regrid");
+
+    FakeAmrLevel &falRef = fakeAmr.fakeAmrLevels[lev];
+    falRef.grids = ChopGrids(grids);
+
+    for (auto& sd : falRef.state) {
+      sd.grids = falRef.grids;
+    }
+}
+
+// ---------------------------------------------------------------
+// Regrid the original levels (if regrid = 1), and then build the new
+// coarse levels from the top down.  Level 0 covers its whole domain.
+// Every other new level covers the footprint of the level above it,
+// coarsened and grown by n_proper cells, so the level above is
+// properly nested in it; the blocking_factor alignment in ChopGrids
+// only adds to that buffer.  The cells of the buffer lie outside the
+// original domain, so (as on level 0) they have no data yet; Castro
+// initializes them when it restarts with castro.grown_factor.
+static void RegridLevels() {
+    const int n = num_new_levels;
+
+    if (regrid_old_levels) {
+      for(int lev(n); lev <= fakeAmr.finest_level; ++lev) {
+        SetLevelGrids(lev, fakeAmr.fakeAmrLevels[lev].grids);
+      }
+    }
+
+    for(int lev(n-1); lev >= 0; --lev) {
+      const Box& domain = fakeAmr.geom[lev].Domain();
+
+      if (lev == 0) {
+        SetLevelGrids(lev, BoxArray(domain));
+        continue;
+      }
+
+      const BoxArray& fine_grids = fakeAmr.fakeAmrLevels[lev+1].grids;
+
+      BoxList bl;
+      for (int b = 0; b < fine_grids.size(); b++) {
+        Box bx = amrex::coarsen(fine_grids[b], ref_ratio);
+        bx.grow(n_proper);
+        bx &= domain;
+        bl.push_back(bx);
+      }
+
+      BoxArray ba(bl);
+      ba.removeOverlap();
+
+      SetLevelGrids(lev, ba);
+    }
+}
+
+// ---------------------------------------------------------------
+// The name of a StateData MultiFab, relative to the Header file.
+static std::string StateDataName (int lev, int i, bool old) {
+    static const std::string NewSuffix("_New_MF");
+    static const std::string OldSuffix("_Old_MF");
+    std::string name = "Level_" + std::to_string(lev) + "/SD_" + std::to_string(i);
+    name += old ? OldSuffix : NewSuffix;
+    return name;
+}
+
+// ---------------------------------------------------------------
+// Distribute the grids of an output level over the ranks.  Both SFC
+// and KNAPSACK weight each grid by its number of cells, which is what
+// the reading, copying and writing of that grid costs.
+static DistributionMapping MakeDistributionMap (const BoxArray& ba) {
+    const DistributionMapping::Strategy old_strategy = DistributionMapping::strategy();
+
+    if (dmap_strategy == "KNAPSACK") {
+      DistributionMapping::strategy(DistributionMapping::KNAPSACK);
+    } else if (dmap_strategy == "ROUNDROBIN") {
+      DistributionMapping::strategy(DistributionMapping::ROUNDROBIN);
+    } else {
+      DistributionMapping::strategy(DistributionMapping::SFC);
+    }
+
+    DistributionMapping dm(ba);
+
+    DistributionMapping::strategy(old_strategy);
+
+    return dm;
+}
+
+// ---------------------------------------------------------------
+// Build one StateData MultiFab of an original level on its new grids
+// and distribution.  Each rank reads, one FAB at a time, only those
+// FABs of the input MultiFab that intersect the grids it owns, so no
+// rank ever holds more than its share of the level plus one input FAB.
+// If crse is given, every cell is first filled by piecewise constant
+// injection from it, so cells that the regridding newly covers (e.g.
+// by aligning to a larger blocking_factor) get sensible values.
+static std::unique_ptr<MultiFab> ReadStateData (int lev, int i, bool old,
+                                                const DistributionMapping& dm,
+                                                const MultiFab* crse) {
+    FakeAmrLevel &falRef = fakeAmr.fakeAmrLevels[lev];
+    const std::string& mf_name = old ? falRef.state[i].old_data_file : falRef.state[i].new_data_file;
+
+    VisMF vmf(mf_name);
+
+    const int ncomp = vmf.nComp();
+    const int ngrow = vmf.nGrow();
+
+    // the input grids, moved into the index space of the new checkpoint
+    BoxArray in_grids(vmf.boxArray());
+    in_grids.shift(falRef.shift);
+
+    auto mf = std::make_unique<MultiFab>(falRef.grids, dm, ncomp, ngrow);
+    mf->setVal(0.);
+
+    if (crse != nullptr && ! in_grids.contains(falRef.grids)) {
+      const IntVect rr = falRef.crse_ratio;
+
+      IntVect cng;
+      for (int d = 0; d < AMREX_SPACEDIM; d++) {
+        cng[d] = (ngrow + rr[d] - 1) / rr[d];
+      }
+
+      MultiFab crse_tmp(amrex::coarsen(falRef.grids, rr), dm, ncomp, cng);
+      crse_tmp.setVal(0.);
+      crse_tmp.ParallelCopy(*crse, 0, 0, ncomp, IntVect::TheZeroVector(), cng);
+
+      for (MFIter mfi(*mf); mfi.isValid(); ++mfi) {
+        const Box& bx = mfi.fabbox();
+        auto const f = mf->array(mfi);
+        auto const c = crse_tmp.const_array(mfi);
+
+        amrex::ParallelFor(bx, ncomp,
+        [=] AMREX_GPU_HOST_DEVICE (int ii, int jj, int kk, int n) noexcept
+        {
+          const IntVect civ = amrex::coarsen(IntVect(AMREX_D_DECL(ii, jj, kk)), rr);
+          f(ii,jj,kk,n) = c(civ,n);
+        });
+      }
+    }
+
+    // For each input FAB we need, the output FABs it overlaps.  Where an
+    // output grid is an input grid unchanged we copy the ghost cells too.
+    std::map<int, Vector<std::pair<int, Box>>> targets;
+
+    for (MFIter mfi(*mf); mfi.isValid(); ++mfi) {
+      const Box& vbx = mfi.validbox();
+      const Box& gbx = mfi.fabbox();
+
+      for (const auto& isect : in_grids.intersections(gbx)) {
+        const Box bx = (in_grids[isect.first] == vbx) ? gbx : isect.second;
+        targets[isect.first].push_back(std::make_pair(mfi.index(), bx));
+      }
+    }
+
+    // The map is sorted by FAB index, so each rank walks through the
+    // input files in order.
+    for (const auto& t : targets) {
+      // a -1 component index reads all the components
+      std::unique_ptr<FArrayBox> fab(vmf.readFAB(t.first, -1));
+      fab->shift(falRef.shift);
+
+      for (const auto& target : t.second) {
+        (*mf)[target.first].copy<RunOn::Host>(*fab, target.second, 0, target.second, 0, ncomp);
+      }
+    }
+
+    return mf;
+}
+
+// ---------------------------------------------------------------
+// Write the data of every level, one StateData MultiFab at a time.  The
+// coarsest original level covers the whole original domain, so we read
+// it first and average it down to fill the new coarse levels (Castro
+// itself only averages the new level 1 onto level 0 on restart).  The
+// finer original levels are then streamed in turn; with regrid = 1 we
+// keep the level below around to fill any newly covered cells.
+static void WriteStateData (const std::string& ckfile) {
+    const int n = num_new_levels;
+    const int finest = fakeAmr.finest_level;
+    const int ndesc = nsets_save.size();
+
+    Vector<DistributionMapping> dmap(finest+1);
+    for(int lev(0); lev <= finest; ++lev) {
+      dmap[lev] = MakeDistributionMap(fakeAmr.fakeAmrLevels[lev].grids);
+    }
+
+    for(int i(0); i < ndesc; ++i) {
+      for(int set(0); set < nsets_save[i]; ++set) {
+        const bool old = (set == 1);
+
+        std::unique_ptr<MultiFab> prev = ReadStateData(n, i, old, dmap[n], nullptr);
+        VisMF::Write(*prev, JoinPath(ckfile, StateDataName(n, i, old)), how);
+
+        const int ncomp = prev->nComp();
+        const int ngrow = prev->nGrow();
+
+        std::unique_ptr<MultiFab> fine_keep;
+        const MultiFab* fine = prev.get();
 
-        if (nsets_save[i] >= 1) {
+        for(int lev(n-1); lev >= 0; --lev) {
+          auto crse = std::make_unique<MultiFab>(fakeAmr.fakeAmrLevels[lev].grids, dmap[lev], ncomp, ngrow);
+          crse->setVal(0.);
 
-           int ncomp = falRef_orig.state[i].new_data->nComp();
-           int ngrow = falRef_orig.state[i].new_data->nGrow();
+          amrex::average_down(*fine, *crse, fakeAmr.geom[lev+1], fakeAmr.geom[lev],
+                              0, ncomp, fakeAmr.ref_ratio[lev]);
 
-	   DistributionMapping dmap {falRef.grids};
-           falRef.state[i].new_data = new MultiFab(falRef.grids, dmap, ncomp, ngrow);
-           falRef.state[i].new_data->setVal(0.);
+          VisMF::Write(*crse, JoinPath(ckfile, StateDataName(lev, i, old)), how);
 
-           if (nsets_save[i] == 2) {
-             falRef.state[i].old_data = new MultiFab(falRef.grids, dmap, ncomp, ngrow);
-             falRef.state[i].old_data->setVal(0.);
-           }
+          fine_keep = std::move(crse);
+          fine = fine_keep.get();
+        }
+        fine_keep.reset();
+
+        for(int lev(n+1); lev <= finest; ++lev) {
+          std::unique_ptr<MultiFab> mf =
+            ReadStateData(lev, i, old, dmap[lev], regrid_old_levels ? prev.get() : nullptr);
+
+          VisMF::Write(*mf, JoinPath(ckfile, StateDataName(lev, i, old)), how);
+
+          if (regrid_old_levels) {
+            prev = std::move(mf);
+          } else {
+            prev.reset();
+          }
+        }
 
+        if(verbose && ParallelDescriptor::IOProcessor()) {
+          std::cout << "Wrote StateData " << i << (old ? " (old)" : " (new)")
+                    << " on all levels" << std::endl;
         }
       }
     }
@@ -518,6 +814,22 @@ static void WriteCheckpointFile(const std::string& inFileName, const std::string
 
     }
 
+    // Build the directories to hold the MultiFabs in the StateData at each level.
+    // Only the I/O processor makes the directories if they don't already exist.
+    if(ParallelDescriptor::IOProcessor()) {
+      for(int lev(0); lev <= fakeAmr.finest_level; ++lev) {
+        std::string FullPath = JoinPath(ckfile, "Level_" + std::to_string(lev));
+        if( ! amrex::UtilCreateDirectory(FullPath, 0755)) {
+          amrex::CreateDirectoryFailed(FullPath);
+        }
+      }
+    }
+    // Force other processors to wait till directories are built.
+    ParallelDescriptor::Barrier();
+
+    // Output state data.
+    WriteStateData(ckfile);
+
     // Write the main header file.
 
     std::string HeaderFileName = ckfile + "/Header";
@@ -564,73 +876,19 @@ static void WriteCheckpointFile(const std::string& inFileName, const std::string
         HeaderFile << '\n';
         for (i = 0; i <= max_level; i++) HeaderFile << fakeAmr.level_count[i] << ' ';
         HeaderFile << '\n';
-    }
-
-    for(int lev(0); lev <= fakeAmr.finest_level; ++lev) {
 
-      std::ostream &os = HeaderFile;
-      FakeAmrLevel &falRef = fakeAmr.fakeAmrLevels[lev];
-      int ndesc = falRef.state.size();
-
-      // Build directory to hold the MultiFabs in the StateData at this level.
-      char buf[64];
-      sprintf(buf, "Level_%d", lev);
-      std::string Level = buf;
-
-      // Now for the full pathname of that directory.
-      std::string FullPath = ckfile;
-      if( ! FullPath.empty() && FullPath[FullPath.length()-1] != '/') {
-        FullPath += '/';
-      }
-      FullPath += Level;
+        for(int lev(0); lev <= fakeAmr.finest_level; ++lev) {
 
-      // Only the I/O processor makes the directory if it doesn't already exist.
-      if(ParallelDescriptor::IOProcessor()) { if( ! amrex::UtilCreateDirectory(FullPath, 0755)) {
-          amrex::CreateDirectoryFailed(FullPath);
-        }
-      }
-      // Force other processors to wait till directory is built.
-      ParallelDescriptor::Barrier();
-
-      if(ParallelDescriptor::IOProcessor()) {
-        os << lev << '\n' << falRef.geom  << '\n';
-        falRef.grids.writeOn(os);
-        os << ndesc << '\n';
-      }
-      //
-      // Output state data.
-      //
-      for(int i(0); i < ndesc; ++i) {
-        //
-        // Now build the full relative pathname of the StateData.
-        // The name is relative to the Header file containing this name.
-        // It's the name that gets written into the Header.
-        //
-        // There is only one MultiFab written out at each level in HyperCLaw.
-        //
-        std::string PathNameInHeader = Level;
-        sprintf(buf, "/SD_%d", i);
-        PathNameInHeader += buf;
-        std::string FullPathName = FullPath;
-        FullPathName += buf;
-        // ++++++++++++ state[i].checkPoint(PathNameInHeader, FullPathName, os, how);
-          static const std::string NewSuffix("_New_MF");
-          static const std::string OldSuffix("_Old_MF");
-          const std::string name(PathNameInHeader);
-          const std::string fullpathname(FullPathName);
-
-          bool dump_old(true);
-          if(dump_old == true && falRef.state[i].old_data == 0) {
-            dump_old = false;
-          }
+          std::ostream &os = HeaderFile;
+          FakeAmrLevel &falRef = fakeAmr.fakeAmrLevels[lev];
+          int ndesc = falRef.state.size();
 
-          if(ParallelDescriptor::IOProcessor()) {
-            // The relative name gets written to the Header file.
-            std::string mf_name_old = name;
-	    mf_name_old += OldSuffix;
-            std::string mf_name_new = name;
-	    mf_name_new += NewSuffix;
+          os << lev << '\n' << falRef.geom  << '\n';
+          falRef.grids.writeOn(os);
+          os << ndesc << '\n';
 
+          // ++++++++++++ state[i].checkPoint(PathNameInHeader, FullPathName, os, how);
+          for(int i(0); i < ndesc; ++i) {
             os << falRef.state[i].domain << '\n';
 
             falRef.state[i].grids.writeOn(os);
@@ -640,37 +898,18 @@ static void WriteCheckpointFile(const std::string& inFileName, const std::string
                << falRef.state[i].new_time.start << '\n'
                << falRef.state[i].new_time.stop  << '\n';
 
-            if (nsets_save[i] > 0) {
-               if(dump_old) {
-                 os << 2 << '\n' << mf_name_new << '\n' << mf_name_old << '\n';
-               } else {
-                 os << 1 << '\n' << mf_name_new << '\n';
-               }
+            // The relative names get written to the Header file.
+            if (nsets_save[i] > 1) {
+              os << 2 << '\n' << StateDataName(lev, i, false) << '\n'
+                 << StateDataName(lev, i, true) << '\n';
+            } else if (nsets_save[i] > 0) {
+              os << 1 << '\n' << StateDataName(lev, i, false) << '\n';
             } else {
               os << 0 << '\n';
             }
-
-          }
-
-          if (nsets_save[i] > 0) {
-             BL_ASSERT(falRef.state[i].new_data);
-             std::string mf_fullpath_new = fullpathname;
-             mf_fullpath_new += NewSuffix;
-             VisMF::Write(*(falRef.state[i].new_data),mf_fullpath_new,how);
-          }
-
-          if (nsets_save[i] > 1) {
-            BL_ASSERT(dump_old);
-            BL_ASSERT(falRef.state[i].old_data);
-            std::string mf_fullpath_old = fullpathname;
-	    mf_fullpath_old += OldSuffix;
-            VisMF::Write(*(falRef.state[i].old_data),mf_fullpath_old,how);
           }
           // ++++++++++++
-      }
-      // ========================
 
-       if (ParallelDescriptor::IOProcessor()) {
           if (lev == 0) {
              std::cout << " " << std::endl;
              std::cout << " **************************************** " << std::endl;
@@ -679,12 +918,10 @@ static void WriteCheckpointFile(const std::string& inFileName, const std::string
           std::cout << "New checkpoint level    " << lev << std::endl;
           std::cout << " ... domain is       " << fakeAmr.geom[lev].Domain() << std::endl;
           std::cout << " ...     dx is       " << fakeAmr.geom[lev].CellSize()[0] << std::endl;
+          std::cout << " ...  grids are      " << falRef.grids.size() << std::endl;
           std::cout << "  " << std::endl;
-       }
-
-    }
+        }
 
-    if(ParallelDescriptor::IOProcessor()) {
         HeaderFile.precision(old_prec);
 
         if( ! HeaderFile.good()) {
@@ -712,7 +949,7 @@ static void ConvertData() {
 #if (AMREX_SPACEDIM >= 2)
    int dleny = domain.size()[1];
 #if (AMREX_SPACEDIM == 3)
-   int dlenz = domain.size()[1];
+   int dlenz = domain.size()[2];
 #endif
 #endif
 
@@ -876,7 +1113,7 @@ static void ConvertData() {
    //    but isn't automatically set.
    fakeAmr.geom[0].SetOffset(xlo);
 
-   IntVect shift_iv[max_level+1];
+   Vector<IntVect> shift_iv(max_level+1, IntVect::TheZeroVector());
 
    // Define the shift IntVect for later
    if (star_at_center == 1)
@@ -922,44 +1159,11 @@ static void ConvertData() {
          falRef.state[n].domain.refine(grown_factor);
    }
 
-   DistributionMapping newdm {newgrids};
-
-   // We need to allocate a MultiFab for new data but don't need to fill it
-   for (int n = 0; n < nstatetypes; n++) 
-   {
-      if (falRef0.state[n].new_data != 0) {
-         int ncomps = (falRef0.state[n].new_data)->nComp();
-         MultiFab * newNewData = new MultiFab(newgrids,newdm,ncomps,1);
-
-         newNewData->setVal(0.); 
-
-         if (star_at_center == 1)  
-            (falRef0.state[n].new_data)->shift(shift_iv[0]);
-
-         falRef0.state[n].new_data = newNewData;
-   
-//       newNewData->copy(*(falRef0.state[n].new_data),0,0,ncomps);
-      }
-   } 
-
-   // If we have old_data as well as new_data
-   for (int n = 0; n < nstatetypes; n++) 
-   {
-      if (falRef0.state[n].old_data != 0) {
-         int ncomps = (falRef0.state[n].old_data)->nComp();
-         MultiFab * newOldData = new MultiFab(newgrids,newdm,ncomps,1);
-         newOldData->setVal(0.);
-
-         if (star_at_center == 1)  
-            (falRef0.state[n].old_data)->shift(shift_iv[0]);
+   // The data itself is shifted as it is streamed in WriteStateData
+   for (int i = 0; i <= max_level; i++)
+      fakeAmr.fakeAmrLevels[i].shift = shift_iv[i];
 
-         falRef0.state[n].old_data = newOldData;
-
-//       newOldData->copy(*(falRef0.state[n].old_data),0,0,ncomps);
-      }
-   }
-
-   // Now shift the data at the higher levels
+   // Now shift the grids at the higher levels
    if (star_at_center == 1) {
       for (int i = 1; i <= max_level; i++) 
       {
@@ -968,17 +1172,9 @@ static void ConvertData() {
          // Shift the grids associated with each level
          falRef.grids.shift(shift_iv[i]);
 
+         // Shift the grids associated with each StateData
          for (int n = 0; n < nstatetypes; n++) 
-         {
-            // Shift the grids associated with each StateData
             falRef.state[n].grids.shift(shift_iv[i]);
-
-            // Shift the grids associated with the MultiFab in each StateData
-            if (falRef0.state[n].new_data != 0) 
-               (falRef.state[n].new_data)->shift(shift_iv[i]);
-            if (falRef0.state[n].old_data != 0) 
-               (falRef.state[n].old_data)->shift(shift_iv[i]);
-         }
       }
    }
 }
@@ -1006,13 +1202,16 @@ int main(int argc, char *argv[]) {
       cout << " " << std::endl;
     }
 
-    // Read in the original checkpoint directory and add a coarser level covering the same domain 
+    // Read in the original checkpoint header and add num_new_levels coarser levels covering the same domain
     ReadCheckpointFile(CheckFileIn);
 
     // Enlarge the new level 0
     ConvertData();
 
-    // Write out the new checkpoint directory
+    // Apply max_grid_size and blocking_factor to the new grids
+    RegridLevels();
+
+    // Write out the new checkpoint directory, streaming the data box by box
     WriteCheckpointFile(CheckFileIn, CheckFileOut);
 
     if(verbose && ParallelDescriptor::IOProcessor()) {
@@ -12,6 +12,8 @@
 #include <network.H>
 #include <castro_params.H>
 #include <exact_riemann.H>
+#include <riemann_batch_bench.H>
+#include <riemann_verify.H>
 
 int main(int argc, char *argv[]) {
 
@@ -36,6 +38,20 @@ int main(int argc, char *argv[]) {
   Real small_dens = 1.e-200;
   eos_init(small_temp, small_dens);
 
-  exact_riemann();
+  // either solve the single Riemann problem of the inputs file, or
+  // verify Castro's approximate solvers on a batch of them
+
+  if (problem::batch_file.empty()) {
+      exact_riemann();
+  } else {
+      riemann_verify_batch();
+  }
+
+  // optionally time Castro's approximate Riemann solvers on interface
+  // states built from the same left and right states
+
+  if (problem::bench_nzones > 0) {
+      riemann_batch_bench();
+  }
 
 }